@@ -0,0 +1,326 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <docopt.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <libabii.h>
+#include "custom_printers.h"
+
+static constexpr auto HELP = R"(
+abii_bench - Microbenchmarks for the ABII printers
+
+Usage: abii_bench [--json <file>] [--filter <text>] [--min-time <ms>]
+
+Options:
+    -h --help                     Show this screen.
+    --version                     Show the version number.
+    --json <file>                 Also write the results to <file> as JSON.
+    --filter <text>               Only run the benchmarks whose name contains <text>.
+    --min-time <ms>               Minimum time spent measuring each benchmark [default: 200].
+)";
+
+/*
+ * Heap allocations made through operator new; printers themselves come from the arena and are not counted
+ */
+static std::atomic<uint64_t> alloc_count = 0;
+static std::atomic<uint64_t> alloc_bytes = 0;
+
+void* operator new(const size_t size)
+{
+    alloc_count.fetch_add(1, std::memory_order_relaxed);
+    alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (const auto ptr = malloc(size == 0 ? 1 : size); ptr != nullptr)
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+namespace
+{
+struct Result
+{
+    std::string name;
+    uint64_t iterations;
+    double ns_per_op;
+    double allocs_per_op;
+    double alloc_bytes_per_op;
+};
+
+/*
+ * Discards everything written to it, so only the formatting is measured
+ */
+class NullBuf final : public std::streambuf
+{
+protected:
+    int_type overflow(const int_type ch) override { return traits_type::not_eof(ch); }
+    std::streamsize xsputn(const char*, const std::streamsize n) override { return n; }
+};
+
+NullBuf null_buf;
+std::ostream null_os(&null_buf);
+
+template <typename T>
+void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+class Runner
+{
+public:
+    Runner(std::string filter, const std::chrono::milliseconds min_time) : filter_(std::move(filter)),
+                                                                          min_time_(min_time) {}
+
+    template <typename F>
+    void run(const std::string& name, F&& body)
+    {
+        if (name.find(filter_) == std::string::npos)
+            return;
+        body();
+
+        // Batches double until one takes long enough to time reliably
+        for (uint64_t iterations = 1;; iterations *= 2)
+        {
+            const auto count = alloc_count.load(std::memory_order_relaxed);
+            const auto bytes = alloc_bytes.load(std::memory_order_relaxed);
+            const auto start = std::chrono::steady_clock::now();
+            for (uint64_t i = 0; i < iterations; ++i)
+                body();
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed < min_time_ && iterations < (1ULL << 40))
+                continue;
+
+            const auto ops = static_cast<double>(iterations);
+            results_.push_back({
+                name, iterations, std::chrono::duration<double, std::nano>(elapsed).count() / ops,
+                static_cast<double>(alloc_count.load(std::memory_order_relaxed) - count) / ops,
+                static_cast<double>(alloc_bytes.load(std::memory_order_relaxed) - bytes) / ops
+            });
+            print(std::cout, results_.back());
+            return;
+        }
+    }
+
+    void write_json(std::ostream& os) const
+    {
+        os << "{\n  \"benchmarks\": [";
+        for (size_t i = 0; i < results_.size(); ++i)
+        {
+            const auto& result = results_[i];
+            os << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name << "\", \"iterations\": "
+                << result.iterations << ", \"ns_per_op\": " << result.ns_per_op << ", \"allocs_per_op\": "
+                << result.allocs_per_op << ", \"alloc_bytes_per_op\": " << result.alloc_bytes_per_op << "}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    static void print_header(std::ostream& os)
+    {
+        os << std::left << std::setw(40) << "benchmark" << std::right << std::setw(14) << "ns/op" << std::setw(14)
+            << "allocs/op" << std::setw(14) << "bytes/op" << std::endl;
+    }
+
+private:
+    static void print(std::ostream& os, const Result& result)
+    {
+        os << std::left << std::setw(40) << result.name << std::right << std::fixed << std::setprecision(1)
+            << std::setw(14) << result.ns_per_op << std::setw(14) << result.allocs_per_op << std::setw(14)
+            << result.alloc_bytes_per_op << std::defaultfloat << std::endl;
+    }
+
+    std::string filter_;
+    std::chrono::milliseconds min_time_;
+    std::vector<Result> results_;
+};
+
+int square(const int x)
+{
+    return x * x;
+}
+
+void print_va_list(const char* fmt, ...)
+{
+    va_list vargs;
+    va_start(vargs, fmt);
+    abii::ArgPrinter printer(vargs, "...", &null_os);
+    printer.set_fmt(fmt);
+    printer.set_va_list_printer(abii::print_variadic_args_printf);
+    printer.print_arg();
+    va_end(vargs);
+}
+
+std::string printf_args(const char* fmt, ...)
+{
+    va_list vargs;
+    va_start(vargs, fmt);
+    auto str = abii::print_variadic_args_printf(fmt, vargs, 0);
+    va_end(vargs);
+    return str;
+}
+
+/*
+ * Two printouts of @p lines lines that differ in every eighth line
+ */
+std::pair<std::string, std::string> printouts(const size_t lines)
+{
+    std::string before, after;
+    for (size_t i = 0; i < lines; ++i)
+    {
+        const auto line = "\t[" + std::to_string(i) + "]: (int) " + std::to_string(i * 7) + "\n";
+        before += line;
+        after += i % 8 == 3 ? "\t[" + std::to_string(i) + "]: (int) -1\n" : line;
+    }
+    return {before, after};
+}
+
+std::vector<std::string> split_lines(const std::string& str)
+{
+    std::vector<std::string> lines;
+    std::istringstream ss(str);
+    for (std::string line; std::getline(ss, line);)
+        lines.push_back(line);
+    return lines;
+}
+
+void run_all(Runner& runner)
+{
+    runner.run("ArgPrinter<int>", [] {
+        int value = 42;
+        abii::ArgPrinter printer(value, "value", &null_os);
+        printer.print_arg();
+    });
+
+    runner.run("ArgPrinter<const char*>", [] {
+        const char* str = "Hello, World!";
+        abii::ArgPrinter printer(str, "str", &null_os);
+        printer.print_arg();
+    });
+
+    runner.run("ArgPrinter<int*> RECURSE len=16", [] {
+        static int values[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+        int* ptr = values;
+        size_t len = 16;
+        abii::ArgPrinter printer(ptr, "ptr", &null_os, PRINT_ENDL | RECURSE);
+        printer.set_len(len);
+        printer.print_arg();
+    });
+
+    runner.run("ArgPrinter<int[16]>", [] {
+        int values[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+        abii::ArgPrinter printer(values, "values", &null_os);
+        printer.print_arg();
+    });
+
+    runner.run("ArgPrinter<int (*)(int)>", [] {
+        int (*func)(int) = square;
+        abii::ArgPrinter printer(func, "func", &null_os);
+        printer.print_arg();
+    });
+
+    runner.run("ArgPrinter<va_list>", [] { print_va_list("%d %s %f\n", 42, "Hello, World!", 3.14); });
+
+    runner.run("ArgsPrinter push_arg+print_args", [] {
+        const auto marker = abii::arena().begin_scope();
+        int fd = 3;
+        const char* path = "/etc/hostname";
+        int flags[4] = {1, 2, 4, 8};
+        int ret = 0;
+        const auto args = new abii::ArgsPrinter();
+        args->push_arg(new abii::ArgPrinter(fd, "fd", &null_os));
+        args->push_arg(new abii::ArgPrinter(path, "path", &null_os));
+        args->push_arg(new abii::ArgPrinter(flags, "flags", &null_os));
+        args->push_return(new abii::ArgPrinter(ret, "ret", &null_os));
+        args->print_args();
+        delete args;
+        abii::arena().end_scope(marker);
+    });
+
+    runner.run("StaticArgsPrinter push_args+print_args", [] {
+        static const auto& func = abii::register_function("bench");
+        const auto marker = abii::arena().begin_scope();
+        int fd = 3;
+        const char* path = "/etc/hostname";
+        int flags[4] = {1, 2, 4, 8};
+        int ret = 0;
+        const auto args = new abii::StaticArgsPrinter(func, "open(fd, path, flags)",
+                                                      [&] { return abii::ArgPrinter(fd, "fd", &null_os); },
+                                                      [&] { return abii::ArgPrinter(path, "path", &null_os); },
+                                                      [&] { return abii::ArgPrinter(flags, "flags", &null_os); });
+        args->set_os(&null_os);
+        args->push_args();
+        args->print_args(ret);
+        delete args;
+        abii::prefix = "";
+        abii::arena().end_scope(marker);
+    });
+
+    for (const size_t lines: {8, 64, 512})
+    {
+        const auto [before, after] = printouts(lines);
+        const auto lines_before = split_lines(before);
+        const auto lines_after = split_lines(after);
+        runner.run("findLCS lines=" + std::to_string(lines), [&] {
+            do_not_optimize(abii::findLCS(lines_before, lines_after));
+        });
+        runner.run("print_diff lines=" + std::to_string(lines), [&] {
+            do_not_optimize(abii::print_diff(before, after));
+        });
+    }
+
+    runner.run("bomb_detector<const char>", [] {
+        static const char* str = "Hello, World!";
+        do_not_optimize(abii::bomb_detector(str));
+    });
+
+    runner.run("bomb_detector<int> size=4096", [] {
+        static std::vector<int> values(4096);
+        do_not_optimize(abii::bomb_detector(values.data(), values.size()));
+    });
+
+    runner.run("print_variadic_args_printf", [] {
+        do_not_optimize(printf_args("%d %s %-8.3f %lld %p\n", 42, "Hello, World!", 3.14, 1LL << 40, &null_os));
+    });
+}
+}
+
+int main(const int argc, char** argv)
+{
+    std::map<std::string, docopt::value> args =
+        docopt::docopt(HELP, {argv + 1, argv + argc}, true, "ABII v0.0.1");
+
+    Runner runner(args["--filter"] ? args["--filter"].asString() : "",
+                  std::chrono::milliseconds(std::stoul(args["--min-time"].asString())));
+    Runner::print_header(std::cout);
+    run_all(runner);
+
+    if (args["--json"])
+    {
+        std::ofstream json(args["--json"].asString());
+        if (!json.is_open())
+        {
+            std::cerr << "Could not open " << args["--json"].asString() << std::endl;
+            return 1;
+        }
+        runner.write_json(json);
+    }
+    return 0;
+}
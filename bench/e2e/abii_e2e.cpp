@@ -0,0 +1,212 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <docopt.h>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+static constexpr auto HELP = R"(
+abii_e2e - End-to-end interposition overhead of ABII on synthetic targets
+
+Usage: abii_e2e [--mode <mode>] [--iterations <n>] [--repeat <n>] [--filter <text>] [--json <file>]
+
+Options:
+    -h --help                     Show this screen.
+    --version                     Show the version number.
+    --mode <mode>                 Logging mode passed to abii, either text, binary or stats [default: text].
+    --iterations <n>              Loop iterations of each target [default: 20000].
+    --repeat <n>                  Runs of each target and configuration, the fastest is kept [default: 3].
+    --filter <text>               Only run the targets whose name contains <text>.
+    --json <file>                 Also write the results to <file> as JSON.
+)";
+
+namespace
+{
+/*
+ * A synthetic target and how many intercepted calls it makes per loop iteration
+ */
+struct Target
+{
+    std::string name;
+    uint64_t calls_per_iteration;
+};
+
+const std::vector<Target> TARGETS = {
+    {"rw_loop", 2},
+    {"printf_storm", 1},
+    {"callbacks", 1},
+    {"threads", 2 * 4},
+};
+
+struct Run
+{
+    double seconds;
+    long max_rss_kb;
+};
+
+struct Result
+{
+    std::string name;
+    uint64_t calls;
+    Run native;
+    Run abii;
+};
+
+/*
+ * Runs @p argv with its output discarded and $HOME pointed at @p home, so the logs stay out of the user's home
+ */
+Run run(const std::vector<std::string>& argv, const std::string& home)
+{
+    std::vector<char*> exec_args;
+    for (const auto& arg: argv)
+        exec_args.push_back(const_cast<char*>(arg.c_str()));
+    exec_args.push_back(nullptr);
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto pid = fork();
+    if (pid < 0)
+        throw std::runtime_error("fork failed");
+    if (pid == 0)
+    {
+        if (const auto null = open("/dev/null", O_WRONLY); null >= 0)
+            dup2(null, STDOUT_FILENO);
+        setenv("HOME", home.c_str(), 1);
+        execv(exec_args[0], exec_args.data());
+        _exit(127);
+    }
+
+    int status;
+    rusage usage{};
+    if (wait4(pid, &status, 0, &usage) != pid)
+        throw std::runtime_error("wait4 failed");
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        throw std::runtime_error(argv.front() + " exited with status " + std::to_string(status));
+    return {std::chrono::duration<double>(elapsed).count(), usage.ru_maxrss};
+}
+
+/*
+ * Fastest of @p repeat runs, with the largest peak RSS seen
+ */
+Run best_of(const std::vector<std::string>& argv, const std::string& home, const unsigned long repeat)
+{
+    Run best{std::numeric_limits<double>::max(), 0};
+    for (unsigned long i = 0; i < repeat; ++i)
+    {
+        const auto current = run(argv, home);
+        best.seconds = std::min(best.seconds, current.seconds);
+        best.max_rss_kb = std::max(best.max_rss_kb, current.max_rss_kb);
+    }
+    return best;
+}
+
+double slowdown(const Result& result)
+{
+    return result.abii.seconds / result.native.seconds;
+}
+
+double overhead_ns(const Result& result)
+{
+    return (result.abii.seconds - result.native.seconds) * 1e9 / static_cast<double>(result.calls);
+}
+
+void print_header(std::ostream& os)
+{
+    os << std::left << std::setw(16) << "target" << std::right << std::setw(12) << "calls" << std::setw(12)
+        << "native ms" << std::setw(12) << "abii ms" << std::setw(10) << "slowdown" << std::setw(14) << "ns/call"
+        << std::setw(14) << "native RSS KB" << std::setw(14) << "abii RSS KB" << std::endl;
+}
+
+void print(std::ostream& os, const Result& result)
+{
+    os << std::left << std::setw(16) << result.name << std::right << std::setw(12) << result.calls << std::fixed
+        << std::setprecision(1) << std::setw(12) << result.native.seconds * 1e3 << std::setw(12)
+        << result.abii.seconds * 1e3 << std::setw(9) << slowdown(result) << "x" << std::setw(14)
+        << overhead_ns(result) << std::setw(14) << result.native.max_rss_kb << std::setw(14)
+        << result.abii.max_rss_kb << std::defaultfloat << std::endl;
+}
+
+void write_json(std::ostream& os, const std::string& mode, const std::vector<Result>& results)
+{
+    os << "{\n  \"mode\": \"" << mode << "\",\n  \"targets\": [";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        os << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << result.name << "\", \"calls\": " << result.calls
+            << ", \"native_seconds\": " << result.native.seconds << ", \"abii_seconds\": " << result.abii.seconds
+            << ", \"slowdown\": " << slowdown(result) << ", \"overhead_ns_per_call\": " << overhead_ns(result)
+            << ", \"native_max_rss_kb\": " << result.native.max_rss_kb << ", \"abii_max_rss_kb\": "
+            << result.abii.max_rss_kb << "}";
+    }
+    os << "\n  ]\n}\n";
+}
+}
+
+int main(const int argc, char** argv)
+{
+    std::map<std::string, docopt::value> args =
+        docopt::docopt(HELP, {argv + 1, argv + argc}, true, "ABII v0.0.1");
+
+    const auto mode = args["--mode"].asString();
+    const auto iterations = std::stoull(args["--iterations"].asString());
+    const auto repeat = std::max(1UL, std::stoul(args["--repeat"].asString()));
+    const auto filter = args["--filter"] ? args["--filter"].asString() : "";
+
+    char home[] = "/tmp/abii_e2e.XXXXXX";
+    if (mkdtemp(home) == nullptr)
+    {
+        std::cerr << "Could not create a temporary directory" << std::endl;
+        return 1;
+    }
+
+    std::vector<Result> results;
+    print_header(std::cout);
+    for (const auto& [name, calls_per_iteration]: TARGETS)
+    {
+        if (name.find(filter) == std::string::npos)
+            continue;
+        const auto target = std::string(ABII_E2E_TARGET_DIR "/abii_e2e_") + name;
+        const std::vector<std::string> native = {target, std::to_string(iterations)};
+        const std::vector<std::string> abii = {
+            ABII_E2E_LAUNCHER, "e2e-logger", "--searchpath", ABII_E2E_PLUGIN_DIR, "--mode", mode, target,
+            std::to_string(iterations)
+        };
+        try
+        {
+            results.push_back({name, iterations * calls_per_iteration, best_of(native, home, repeat),
+                               best_of(abii, home, repeat)});
+        }
+        catch (const std::runtime_error& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+        print(std::cout, results.back());
+    }
+    std::cout << "Logs written to " << home << "/abii_log" << std::endl;
+
+    if (args["--json"])
+    {
+        std::ofstream json(args["--json"].asString());
+        if (!json.is_open())
+        {
+            std::cerr << "Could not open " << args["--json"].asString() << std::endl;
+            return 1;
+        }
+        write_json(json, mode, results);
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include <cstdlib>
+
+namespace
+{
+int compare(const void* a, const void* b)
+{
+    const auto x = *static_cast<const int*>(a);
+    const auto y = *static_cast<const int*>(b);
+    return (x > y) - (x < y);
+}
+}
+
+/*
+ * qsort() of a small array with a comparator: 1 intercepted call per iteration, each taking a function pointer
+ */
+int main(const int argc, char** argv)
+{
+    const auto iterations = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+    int values[16];
+    for (unsigned long long i = 0; i < iterations; ++i)
+    {
+        for (auto j = 0; j < 16; ++j)
+            values[j] = static_cast<int>((i + j * 7) % 16);
+        qsort(values, 16, sizeof(int), compare);
+        if (values[0] > values[15])
+            return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,92 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+#include <libabii.h>
+#include "custom_printers.h"
+
+/*
+ * Logs the functions the synthetic targets call
+ */
+
+REAL_FUNCTION(read, real_read)
+REAL_FUNCTION(write, real_write)
+REAL_FUNCTION(vprintf, real_vprintf)
+REAL_FUNCTION(qsort, real_qsort)
+
+extern "C" ssize_t read(int fd, void* buf, size_t nbytes)
+{
+    OVERRIDE_PREFIX(real_read)
+        abii::pre_fmtd_str str = "read(fd, buf, nbytes)";
+        abii_args->push_func(new abii::ArgPrinter(str));
+        abii_args->push_arg(new abii::ArgPrinter(fd, "fd"));
+        const auto buf_printer = new abii::ArgPrinter(buf, "buf");
+        buf_printer->set_len(nbytes);
+        abii_args->push_arg(buf_printer);
+        abii_args->push_arg(new abii::ArgPrinter(nbytes, "nbytes"));
+        const auto ret = real_read(fd, buf, nbytes);
+        abii_args->push_return(new abii::ArgPrinter(ret, "return"));
+    OVERRIDE_SUFFIX(real_read, ret)
+    return real_read(fd, buf, nbytes);
+}
+
+extern "C" ssize_t write(int fd, const void* buf, size_t n)
+{
+    OVERRIDE_PREFIX(real_write)
+        abii::pre_fmtd_str str = "write(fd, buf, n)";
+        abii_args->push_func(new abii::ArgPrinter(str));
+        abii_args->push_arg(new abii::ArgPrinter(fd, "fd"));
+        const auto buf_printer = new abii::ArgPrinter(buf, "buf");
+        buf_printer->set_len(n);
+        abii_args->push_arg(buf_printer);
+        abii_args->push_arg(new abii::ArgPrinter(n, "n"));
+        const auto ret = real_write(fd, buf, n);
+        abii_args->push_return(new abii::ArgPrinter(ret, "return"));
+    OVERRIDE_SUFFIX(real_write, ret)
+    return real_write(fd, buf, n);
+}
+
+extern "C" int printf(const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    OVERRIDE_VALIST_PREFIX(real_vprintf, fmt, args)
+        abii::pre_fmtd_str str = "printf(fmt, ...)";
+        abii_args->push_func(new abii::ArgPrinter(str));
+        abii_args->push_arg(new abii::ArgPrinter(fmt, "__fmt"));
+        const auto printer = new abii::ArgPrinter(abii_vargs, "...");
+        printer->set_fmt(fmt);
+        printer->set_va_list_printer(abii::print_variadic_args_printf);
+        abii_args->push_arg(printer);
+        va_list call_args;
+        va_copy(call_args, args);
+        const auto ret = real_vprintf(fmt, call_args);
+        va_end(call_args);
+        abii_args->push_return(new abii::ArgPrinter(ret, "return"));
+        // Printing consumed abii_vargs, which print_args() reads again
+        va_end(abii_vargs);
+        va_copy(abii_vargs, args);
+        va_end(args);
+    OVERRIDE_VALIST_SUFFIX(real_vprintf, ret, fmt)
+    const auto ret = real_vprintf(fmt, args);
+    va_end(args);
+    return ret;
+}
+
+extern "C" void qsort(void* base, size_t nmemb, size_t size, __compar_fn_t compar)
+{
+    OVERRIDE_PREFIX(real_qsort)
+        abii::pre_fmtd_str str = "qsort(base, nmemb, size, compar)";
+        abii_args->push_func(new abii::ArgPrinter(str));
+        abii_args->push_arg(new abii::ArgPrinter(base, "base"));
+        abii_args->push_arg(new abii::ArgPrinter(nmemb, "nmemb"));
+        abii_args->push_arg(new abii::ArgPrinter(size, "size"));
+        abii_args->push_arg(new abii::ArgPrinter(compar, "compar"));
+        real_qsort(base, nmemb, size, compar);
+    OVERRIDE_SUFFIX(real_qsort, )
+    real_qsort(base, nmemb, size, compar);
+}
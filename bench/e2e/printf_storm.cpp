@@ -0,0 +1,17 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include <cstdio>
+#include <cstdlib>
+
+/*
+ * printf() with mixed conversions: 1 intercepted call per iteration
+ */
+int main(const int argc, char** argv)
+{
+    const auto iterations = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+    for (unsigned long long i = 0; i < iterations; ++i)
+        printf("%llu %s %8.3f %p\n", i, "storm", static_cast<double>(i) / 3, static_cast<void*>(&i));
+    return 0;
+}
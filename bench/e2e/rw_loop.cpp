@@ -0,0 +1,26 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+/*
+ * Tight read/write loop: 2 intercepted calls per iteration
+ */
+int main(const int argc, char** argv)
+{
+    const auto iterations = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+    const auto in = open("/dev/zero", O_RDONLY);
+    const auto out = open("/dev/null", O_WRONLY);
+    char buf[64];
+    for (unsigned long long i = 0; i < iterations; ++i)
+    {
+        if (read(in, buf, sizeof(buf)) != sizeof(buf) || write(out, buf, sizeof(buf)) != sizeof(buf))
+            return 1;
+    }
+    close(in);
+    close(out);
+    return 0;
+}
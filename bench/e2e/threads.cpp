@@ -0,0 +1,36 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+constexpr auto THREADS = 4;
+
+/*
+ * The read/write loop on THREADS threads at once: 2 intercepted calls per iteration per thread
+ */
+int main(const int argc, char** argv)
+{
+    const auto iterations = argc > 1 ? strtoull(argv[1], nullptr, 10) : 100000;
+    std::vector<std::thread> threads;
+    for (auto t = 0; t < THREADS; ++t)
+        threads.emplace_back([iterations] {
+            const auto in = open("/dev/zero", O_RDONLY);
+            const auto out = open("/dev/null", O_WRONLY);
+            char buf[64];
+            for (unsigned long long i = 0; i < iterations; ++i)
+            {
+                if (read(in, buf, sizeof(buf)) != sizeof(buf) || write(out, buf, sizeof(buf)) != sizeof(buf))
+                    abort();
+            }
+            close(in);
+            close(out);
+        });
+    for (auto& thread: threads)
+        thread.join();
+    return 0;
+}
@@ -13,12 +13,18 @@
 static constexpr auto HELP = R"(
 ABII - Application Binary Interface Interceptor
 
-Usage: abii <plugin> [--searchpath <searchpath>] <program> [<args>...]
+Usage: abii <plugin> [--searchpath <searchpath>] [--mode <mode>] [--filter <rules>] [--sample <spec>] [--timing] [--dedup] [--compress <level>] <program> [<args>...]
 
 Options:
     -h --help                     Show this screen.
     --version                     Show the version number.
     --searchpath <searchpath>     Additional colon-separated plugin search path.
+    --mode <mode>                 Logging mode, either text, binary or stats [default: text].
+    --filter <rules>              Only log the matching functions, eg. open*,read,-openat or @<file>.
+    --sample <spec>               Only log some calls, eg. every=10,malloc:rate=100,budget=100000.
+    --timing                      Time every logged call and write latency percentiles at exit.
+    --dedup                       Print objects shared within an argument once and refer to them by ID afterwards.
+    --compress <level>            Write the text log as gzip blocks, level 1 (fastest) to 9.
 )";
 
 static constexpr auto BASE_PATH = "/usr/share/abii/plugins/";
@@ -34,6 +40,7 @@ int main(const int argc, char** argv)
     launch_args.push_back(program);
     for (const auto& arg : args["<args>"].asStringList())
         launch_args.push_back(arg.c_str());
+    launch_args.push_back(nullptr);
 
     const char* old_ld_library_path = getenv("LD_LIBRARY_PATH");
     const char* old_ld_preload = getenv("LD_PRELOAD");
@@ -58,6 +65,17 @@ int main(const int argc, char** argv)
         ld_preload += old_ld_preload;
     }
 
+    setenv("ABII_MODE", args["--mode"].asString().c_str(), 1);
+    if (args["--filter"])
+        setenv("ABII_FILTER", args["--filter"].asString().c_str(), 1);
+    if (args["--timing"].asBool())
+        setenv("ABII_TIMING", "1", 1);
+    if (args["--dedup"].asBool())
+        setenv("ABII_DEDUP", "1", 1);
+    if (args["--sample"])
+        setenv("ABII_SAMPLE", args["--sample"].asString().c_str(), 1);
+    if (args["--compress"])
+        setenv("ABII_COMPRESS", args["--compress"].asString().c_str(), 1);
     setenv("LD_LIBRARY_PATH", ld_library_path.c_str(), 1);
     setenv("LD_PRELOAD", ld_preload.c_str(), 1);
 
@@ -0,0 +1,287 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "AddressMap.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <link.h>
+#include <mutex>
+#include <pthread.h>
+#include <sstream>
+#include <unistd.h>
+
+namespace abii
+{
+namespace
+{
+int collect_segments(dl_phdr_info* info, size_t, void* data)
+{
+    const auto segments = static_cast<std::vector<std::pair<uintptr_t, uintptr_t>>*>(data);
+    const auto page_mask = ~(static_cast<uintptr_t>(sysconf(_SC_PAGESIZE)) - 1);
+    for (auto i = 0; i < info->dlpi_phnum; ++i)
+        if (const auto& phdr = info->dlpi_phdr[i]; phdr.p_type == PT_LOAD)
+        {
+            const auto start = (info->dlpi_addr + phdr.p_vaddr) & page_mask;
+            const auto end = (info->dlpi_addr + phdr.p_vaddr + phdr.p_memsz + ~page_mask) & page_mask;
+            segments->emplace_back(start, end);
+        }
+    return 0;
+}
+
+int count_unloads(dl_phdr_info* info, size_t, void* data)
+{
+    *static_cast<unsigned long long*>(data) = info->dlpi_subs;
+    return 1;
+}
+
+std::atomic<const link_map*> link_map_tail = nullptr;
+std::atomic<unsigned long long> link_map_changes = 0;
+std::atomic<unsigned long long> link_map_unloads = 0;
+}
+
+unsigned long long link_map_generation()
+{
+    // Loaded objects are appended to the link map, so nothing was loaded as long as the last object seen is still last.
+    // This is read without the loader lock, which dl_iterate_phdr() would take.
+    if (const auto tail = link_map_tail.load(std::memory_order_acquire);
+        tail != nullptr && __atomic_load_n(&tail->l_next, __ATOMIC_ACQUIRE) == nullptr)
+        return link_map_changes.load(std::memory_order_acquire);
+
+    auto last = _r_debug.r_map;
+    if (last == nullptr)
+        return link_map_changes.load(std::memory_order_acquire);
+    while (const auto next = __atomic_load_n(&last->l_next, __ATOMIC_ACQUIRE))
+        last = next;
+    link_map_tail.store(last, std::memory_order_release);
+    return link_map_changes.fetch_add(1, std::memory_order_acq_rel) + 1;
+}
+
+void link_map_unloaded()
+{
+    unsigned long long unloads = 0;
+    dl_iterate_phdr(count_unloads, &unloads);
+    if (link_map_unloads.exchange(unloads, std::memory_order_acq_rel) != unloads)
+    {
+        // The last object seen may be gone, so the link map is walked again
+        link_map_tail.store(nullptr, std::memory_order_release);
+        link_map_changes.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+namespace
+{
+/*
+ * [current frame, top of stack) of the calling thread is always mapped, as long as the frame is on the thread's stack
+ * and not on a signal, coroutine or fiber stack mapped elsewhere
+ */
+size_t stack_extent(const uintptr_t addr)
+{
+    thread_local const auto stack = [] {
+        pthread_attr_t attr;
+        if (pthread_getattr_np(pthread_self(), &attr) != 0)
+            return std::pair<uintptr_t, uintptr_t>(0, 0);
+        void* stack_addr;
+        size_t stack_size;
+        pthread_attr_getstack(&attr, &stack_addr, &stack_size);
+        pthread_attr_destroy(&attr);
+        return std::pair(reinterpret_cast<uintptr_t>(stack_addr), reinterpret_cast<uintptr_t>(stack_addr) + stack_size);
+    }();
+    const auto [stack_addr, stack_top] = stack;
+    const auto frame = reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+    if (frame < stack_addr || frame >= stack_top)
+        return 0;
+    if (frame <= addr && addr < stack_top)
+        return stack_top - addr;
+    return 0;
+}
+}
+
+std::vector<MapsEntry> parse_maps(std::istream& maps)
+{
+    std::vector<MapsEntry> entries;
+    std::string line;
+    while (std::getline(maps, line))
+    {
+        std::istringstream iss(line);
+        MapsEntry entry;
+        std::string range, offset, dev, inode;
+        if (!(iss >> range >> entry.perms >> offset >> dev >> inode))
+            continue;
+        const auto dash = range.find('-');
+        if (dash == std::string::npos)
+            continue;
+        entry.start = std::stoull(range.substr(0, dash), nullptr, 16);
+        entry.end = std::stoull(range.substr(dash + 1), nullptr, 16);
+        std::getline(iss, entry.path);
+        // Remove leading spaces
+        if (const size_t start = entry.path.find_first_not_of(' '); start != std::string::npos)
+            entry.path = entry.path.substr(start);
+        else
+            entry.path.clear();
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+AddressMap::AddressMap()
+{
+    reload();
+}
+
+size_t AddressMap::readable_extent(const uintptr_t addr)
+{
+    if (const auto extent = stack_extent(addr); extent != 0)
+        return extent;
+
+    // dlopen() is not interposed, as that would make us its caller for $ORIGIN and RUNPATH lookups
+    if (const auto generation = link_map_generation(); generation != generation_.load(std::memory_order_acquire))
+    {
+        std::unique_lock lock(mutex_);
+        if (generation != generation_.load(std::memory_order_relaxed))
+            reload_locked();
+    }
+
+    std::shared_lock lock(mutex_);
+    if (heap_start_ != 0 && addr >= heap_start_)
+        // glibc moves the break through an internal __brk(), so the end of the heap is read at lookup time
+        if (const auto brk = reinterpret_cast<uintptr_t>(sbrk(0)); addr < brk)
+            return brk - addr;
+
+    auto it = regions_.upper_bound(addr);
+    if (it == regions_.begin())
+        return 0;
+    --it;
+    auto pos = addr;
+    for (; it != regions_.end() && it->first <= pos && pos < it->second.end; ++it)
+    {
+        if (!it->second.readable || (it->second.cls == IMAGE && !images_valid_))
+            break;
+        pos = it->second.end;
+    }
+    return pos - addr;
+}
+
+void AddressMap::reload()
+{
+    std::unique_lock lock(mutex_);
+    reload_locked();
+}
+
+void AddressMap::add(const uintptr_t start, const size_t size, const bool readable)
+{
+    std::unique_lock lock(mutex_);
+    erase_range(start, start + size);
+    regions_.emplace(start, Region{start + size, MAPPED, readable});
+}
+
+bool AddressMap::remove(const uintptr_t start, const size_t size)
+{
+    std::unique_lock lock(mutex_);
+    // Only anonymous mappings are MAPPED, so images, the heap and the stack never count
+    auto pos = start;
+    auto it = regions_.upper_bound(start);
+    if (it != regions_.begin())
+        for (--it; it != regions_.end() && it->first <= pos && pos < it->second.end; ++it)
+        {
+            if (it->second.cls != MAPPED || !it->second.readable)
+                break;
+            pos = it->second.end;
+        }
+    erase_range(start, start + size);
+    return pos >= start + size;
+}
+
+void AddressMap::protect(const uintptr_t start, const size_t size, const bool readable)
+{
+    std::unique_lock lock(mutex_);
+    split_at(start);
+    split_at(start + size);
+    for (auto it = regions_.lower_bound(start); it != regions_.end() && it->first < start + size; ++it)
+        it->second.readable = readable;
+}
+
+void AddressMap::begin_unload()
+{
+    std::unique_lock lock(mutex_);
+    images_valid_ = false;
+}
+
+void AddressMap::end_unload()
+{
+    std::unique_lock lock(mutex_);
+    if (link_map_generation() != generation_.load(std::memory_order_relaxed))
+        reload_locked();
+    images_valid_ = true;
+}
+
+/*
+ * Makes sure no region spans @p addr, so ranges starting or ending there can be updated in place
+ */
+void AddressMap::split_at(const uintptr_t addr)
+{
+    auto it = regions_.upper_bound(addr);
+    if (it == regions_.begin())
+        return;
+    --it;
+    if (it->first < addr && addr < it->second.end)
+    {
+        auto tail = it->second;
+        it->second.end = addr;
+        regions_.emplace(addr, tail);
+    }
+}
+
+void AddressMap::erase_range(const uintptr_t start, const uintptr_t end)
+{
+    split_at(start);
+    split_at(end);
+    regions_.erase(regions_.lower_bound(start), regions_.lower_bound(end));
+}
+
+void AddressMap::reload_locked()
+{
+    std::ifstream maps("/proc/self/maps");
+    if (!maps.is_open())
+    {
+        std::cerr << "Failed to open /proc/self/maps\n";
+        return;
+    }
+    const auto entries = parse_maps(maps);
+
+    // Read first, so an object loaded while the segments are collected triggers another reload
+    generation_.store(link_map_generation(), std::memory_order_release);
+    std::vector<std::pair<uintptr_t, uintptr_t>> segments;
+    dl_iterate_phdr(collect_segments, &segments);
+
+    std::erase_if(regions_, [](const auto& region) { return region.second.cls == IMAGE; });
+    heap_start_ = 0;
+    for (const auto& entry: entries)
+    {
+        if (entry.path == "[heap]")
+        {
+            heap_start_ = entry.start;
+            continue;
+        }
+        // Only trust mappings that lie inside a segment of a loaded object; they live as long as the object does
+        const auto in_object = std::ranges::any_of(segments, [&](const auto& segment) {
+            return segment.first <= entry.start && entry.end <= segment.second;
+        });
+        if (!in_object)
+            continue;
+        erase_range(entry.start, entry.end);
+        regions_.emplace(entry.start, Region{entry.end, IMAGE, entry.perms[0] == 'r'});
+    }
+    // Without a [heap] line the break has not moved yet, so it is still the start of the heap
+    if (heap_start_ == 0)
+        heap_start_ = reinterpret_cast<uintptr_t>(sbrk(0));
+}
+
+AddressMap& address_map()
+{
+    static AddressMap map;
+    return map;
+}
+}
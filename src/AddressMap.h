@@ -0,0 +1,149 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_ADDRESSMAP_H
+#define ABII_ADDRESSMAP_H
+
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <map>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+namespace abii
+{
+/**
+ * One line of /proc/<pid>/maps
+ *
+ * @struct MapsEntry AddressMap.h
+ */
+struct MapsEntry
+{
+    uintptr_t start;
+    uintptr_t end;
+    std::string perms;
+    std::string path;
+};
+
+/**
+ * parse_maps() - Parses the contents of a /proc/<pid>/maps file
+ *
+ * @param maps Stream positioned at the start of the file
+ * @return One entry per well-formed line, in address order
+ */
+std::vector<MapsEntry> parse_maps(std::istream& maps);
+
+/**
+ * link_map_generation() - Returns a counter that changes whenever an object is loaded into or unloaded from the link
+ * map
+ *
+ * Loads are noticed by checking whether the last object of the main link map gained a successor, which costs one load
+ * without taking the loader lock. Unloads are only noticed once link_map_unloaded() is called.
+ */
+unsigned long long link_map_generation();
+
+/**
+ * link_map_unloaded() - Makes link_map_generation() change if an object was unloaded since the last call
+ *
+ * Called by the dlclose() interceptor after the real dlclose().
+ */
+void link_map_unloaded();
+
+enum region_class
+{
+    IMAGE,
+    MAPPED
+};
+
+/**
+ * User-space cache of the readable parts of our address space
+ *
+ * The cache only answers "known readable"; anything it cannot vouch for must still be probed. It tracks:
+ *  - IMAGE: segments of the objects in the link map, seeded from /proc/self/maps and refreshed whenever
+ *    link_map_generation() changes
+ *  - MAPPED: anonymous mappings the program created through the intercepted mmap() family; file mappings fault past
+ *    the end of the file, so they are left to the probe
+ *  - the heap, from its start in /proc/self/maps up to the current break
+ *  - the calling thread's stack, from the current frame up to the top of the stack
+ *
+ * Mappings libc creates internally (malloc arenas, thread stacks, ...) never go through an interposable symbol, so
+ * they are never trusted.
+ *
+ * @class AddressMap AddressMap.h
+ */
+class AddressMap
+{
+public:
+    AddressMap();
+
+    /**
+     * readable_extent() - Returns how many bytes starting at @p addr are known to be readable
+     *
+     * @param addr Address to look up
+     * @return Number of contiguous readable bytes from @p addr, or 0 if nothing is known about it
+     */
+    size_t readable_extent(uintptr_t addr);
+
+    /**
+     * reload() - Rebuilds the IMAGE regions and the heap start from /proc/self/maps
+     */
+    void reload();
+
+    /**
+     * add() - Records a mapping created by the program
+     */
+    void add(uintptr_t start, size_t size, bool readable);
+
+    /**
+     * remove() - Forgets [@p start, @p start + @p size)
+     *
+     * @return true if the whole range was a readable anonymous mapping recorded with add(), whose pages cannot fault
+     */
+    bool remove(uintptr_t start, size_t size);
+
+    /**
+     * protect() - Updates the readability of the known regions overlapping [@p start, @p start + @p size)
+     */
+    void protect(uintptr_t start, size_t size, bool readable);
+
+    /**
+     * begin_unload() - Stops trusting IMAGE regions until end_unload() is called
+     *
+     * Called before dlclose(), which may unmap any object in the link map.
+     */
+    void begin_unload();
+
+    /**
+     * end_unload() - Trusts IMAGE regions again, reloading them if an object was unloaded
+     */
+    void end_unload();
+
+private:
+    struct Region
+    {
+        uintptr_t end;
+        region_class cls;
+        bool readable;
+    };
+
+    void split_at(uintptr_t addr);
+    void erase_range(uintptr_t start, uintptr_t end);
+    void reload_locked();
+
+    std::map<uintptr_t, Region> regions_;
+    uintptr_t heap_start_ = 0;
+    bool images_valid_ = true;
+    std::atomic<unsigned long long> generation_ = 0;
+    mutable std::shared_mutex mutex_;
+};
+
+/**
+ * address_map() - Returns the process-wide AddressMap, seeding it on first use
+ */
+AddressMap& address_map();
+}
+
+#endif //ABII_ADDRESSMAP_H
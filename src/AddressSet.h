@@ -0,0 +1,184 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_ADDRESSSET_H
+#define ABII_ADDRESSSET_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace abii
+{
+/**
+ * Open-addressing hash table keyed by non-null addresses
+ *
+ * The first 64 slots are stored inline, so the usual shallow structures never allocate. Linear probing with
+ * backward-shift deletion keeps the table free of tombstones, which matters since the recursion guard erases every
+ * key it inserts.
+ *
+ * @class AddressTable AddressSet.h
+ */
+template <typename V>
+class AddressTable
+{
+public:
+    AddressTable() = default;
+    AddressTable(const AddressTable&) = delete;
+    AddressTable& operator=(const AddressTable&) = delete;
+
+    /**
+     * find() - Looks up @p addr
+     *
+     * @return The value stored for @p addr, or nullptr if it is not in the table
+     */
+    [[nodiscard]] V* find(const uintptr_t addr) const
+    {
+        for (auto i = hash(addr);; i = (i + 1) & mask_)
+        {
+            if (slots_[i].key == addr)
+                return &slots_[i].value;
+            if (slots_[i].key == 0)
+                return nullptr;
+        }
+    }
+
+    [[nodiscard]] bool contains(const uintptr_t addr) const
+    {
+        return find(addr) != nullptr;
+    }
+
+    /**
+     * insert() - Adds @p addr, which must not be in the table yet
+     */
+    void insert(const uintptr_t addr, const V& value = {})
+    {
+        // Keep the load factor under 1/2 so that probe runs stay short
+        if (2 * (size_ + 1) > mask_ + 1)
+            grow();
+        place(addr, value);
+        ++size_;
+    }
+
+    /**
+     * erase() - Removes @p addr, which must be in the table
+     */
+    void erase(const uintptr_t addr)
+    {
+        auto hole = hash(addr);
+        while (slots_[hole].key != addr)
+            hole = (hole + 1) & mask_;
+        // Pull back every following entry of the run that would not be found past the hole anymore
+        for (auto i = (hole + 1) & mask_; slots_[i].key != 0; i = (i + 1) & mask_)
+            if (const auto home = hash(slots_[i].key); ((i - home) & mask_) >= ((i - hole) & mask_))
+            {
+                slots_[hole] = slots_[i];
+                hole = i;
+            }
+        slots_[hole] = {};
+        --size_;
+    }
+
+    /**
+     * clear() - Removes every entry, keeping the capacity
+     */
+    void clear()
+    {
+        if (size_ == 0)
+            return;
+        std::fill(slots_, slots_ + mask_ + 1, Slot{});
+        size_ = 0;
+    }
+
+    [[nodiscard]] size_t size() const { return size_; }
+    [[nodiscard]] bool empty() const { return size_ == 0; }
+
+private:
+    struct Slot
+    {
+        uintptr_t key = 0;
+        V value{};
+    };
+
+    [[nodiscard]] size_t hash(const uintptr_t addr) const
+    {
+        // Fibonacci hashing; the top bits are the best mixed
+        return (addr * 0x9E3779B97F4A7C15ull) >> (64 - shift_) & mask_;
+    }
+
+    void place(const uintptr_t addr, const V& value)
+    {
+        auto i = hash(addr);
+        while (slots_[i].key != 0)
+            i = (i + 1) & mask_;
+        slots_[i] = {addr, value};
+    }
+
+    void grow()
+    {
+        const auto old_slots = slots_;
+        const auto old_capacity = mask_ + 1;
+        auto heap = std::make_unique<Slot[]>(old_capacity * 2);
+        slots_ = heap.get();
+        mask_ = old_capacity * 2 - 1;
+        ++shift_;
+        for (size_t i = 0; i < old_capacity; ++i)
+            if (old_slots[i].key != 0)
+                place(old_slots[i].key, old_slots[i].value);
+        heap_ = std::move(heap);
+    }
+
+    static constexpr size_t inline_capacity = 64;
+
+    std::array<Slot, inline_capacity> inline_{};
+    std::unique_ptr<Slot[]> heap_;
+    Slot* slots_ = inline_.data();
+    size_t mask_ = inline_capacity - 1;
+    size_t shift_ = 6;
+    size_t size_ = 0;
+};
+
+/**
+ * Set of the addresses being printed, used as a stack
+ *
+ * @class AddressSet AddressSet.h
+ */
+class AddressSet
+{
+public:
+    [[nodiscard]] bool contains(const uintptr_t addr) const { return table_.contains(addr); }
+
+    /**
+     * push() - Adds @p addr, which must not be in the set yet
+     */
+    void push(const uintptr_t addr)
+    {
+        table_.insert(addr);
+        stack_.push_back(addr);
+    }
+
+    /**
+     * pop() - Removes the address pushed last
+     */
+    void pop()
+    {
+        table_.erase(stack_.back());
+        stack_.pop_back();
+    }
+
+    [[nodiscard]] size_t size() const { return stack_.size(); }
+    [[nodiscard]] bool empty() const { return stack_.empty(); }
+
+private:
+    struct Empty {};
+
+    AddressTable<Empty> table_;
+    std::vector<uintptr_t> stack_;
+};
+} // abii
+
+#endif //ABII_ADDRESSSET_H
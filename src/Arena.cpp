@@ -0,0 +1,94 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <numeric>
+
+namespace abii
+{
+namespace
+{
+constexpr size_t BLOCK_SIZE = 64 * 1024;
+// Objects are preceded by whether they came from the arena, keeping them aligned like operator new would
+constexpr size_t OBJECT_HEADER = alignof(std::max_align_t);
+}
+
+void* Arena::allocate(const size_t size, const size_t align)
+{
+    while (current_ < blocks_.size())
+    {
+        const auto& block = blocks_[current_];
+        const auto base = reinterpret_cast<uintptr_t>(block.data.get());
+        const auto start = (base + offset_ + align - 1) & ~(align - 1);
+        if (start + size <= base + block.size)
+        {
+            offset_ = start + size - base;
+            return reinterpret_cast<void*>(start);
+        }
+        // The rest of this block stays unused until the next rewind
+        ++current_;
+        offset_ = 0;
+    }
+
+    const auto block_size = std::max(BLOCK_SIZE, size + align);
+    // Blocks are handed out uninitialized, so there is no point in zeroing them
+    blocks_.push_back({std::make_unique_for_overwrite<std::byte[]>(block_size), block_size});
+    current_ = blocks_.size() - 1;
+    offset_ = 0;
+    return allocate(size, align);
+}
+
+void Arena::release(const Marker marker)
+{
+    current_ = marker.block;
+    offset_ = marker.offset;
+}
+
+Arena::Marker Arena::begin_scope()
+{
+    ++scopes_;
+    return mark();
+}
+
+void Arena::end_scope(const Marker marker)
+{
+    release(marker);
+    --scopes_;
+}
+
+size_t Arena::capacity() const
+{
+    return std::accumulate(blocks_.begin(), blocks_.end(), static_cast<size_t>(0),
+                           [](const size_t sum, const Block& block) { return sum + block.size; });
+}
+
+Arena& arena()
+{
+    thread_local Arena thread_arena;
+    return thread_arena;
+}
+
+void* allocate_object(const size_t size)
+{
+    auto& thread_arena = arena();
+    const auto from_arena = thread_arena.in_scope();
+    const auto base = static_cast<std::byte*>(from_arena ? thread_arena.allocate(size + OBJECT_HEADER)
+                                                         : ::operator new(size + OBJECT_HEADER));
+    *reinterpret_cast<bool*>(base) = from_arena;
+    return base + OBJECT_HEADER;
+}
+
+void deallocate_object(void* ptr)
+{
+    if (ptr == nullptr)
+        return;
+    const auto base = static_cast<std::byte*>(ptr) - OBJECT_HEADER;
+    if (!*reinterpret_cast<bool*>(base))
+        ::operator delete(base);
+}
+}
@@ -0,0 +1,128 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_ARENA_H
+#define ABII_ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace abii
+{
+/**
+ * Thread-local bump allocator for the objects built while an intercepted call is printed
+ *
+ * Memory is handed out from large blocks and only reclaimed by rewinding to a marker, so allocating costs a pointer
+ * bump and freeing costs nothing. Blocks are kept after a rewind, so printers and argument vectors stop calling malloc
+ * once a thread's blocks are large enough for its biggest call. The strings printers format, such as names, values and
+ * snapshots, still come from the heap.
+ *
+ * Printers only use the arena between begin_scope() and end_scope(), which the override macros call around each
+ * intercepted call. Printers built anywhere else come from the heap, since nothing would ever rewind past them.
+ *
+ * @class Arena Arena.h
+ */
+class Arena
+{
+public:
+    struct Marker
+    {
+        size_t block;
+        size_t offset;
+    };
+
+    Arena() = default;
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * allocate() - Returns @p size bytes aligned to @p align that stay valid until the arena is rewound past them
+     */
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+    /**
+     * mark() - Returns the current position, to be passed to release() once everything allocated after it is dead
+     */
+    [[nodiscard]] Marker mark() const { return {current_, offset_}; }
+
+    /**
+     * release() - Rewinds the arena to @p marker; the memory allocated since is reused by later allocations
+     */
+    void release(Marker marker);
+
+    /**
+     * begin_scope() - Like mark(), and makes allocate_object() use the arena until the matching end_scope()
+     */
+    [[nodiscard]] Marker begin_scope();
+
+    /**
+     * end_scope() - Rewinds the arena to the @p marker returned by the matching begin_scope()
+     */
+    void end_scope(Marker marker);
+
+    /**
+     * in_scope() - Whether a scope opened by begin_scope() is still open
+     */
+    [[nodiscard]] bool in_scope() const { return scopes_ > 0; }
+
+    /**
+     * capacity() - Total size of the blocks owned by the arena
+     */
+    [[nodiscard]] size_t capacity() const;
+
+private:
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_;
+    size_t current_ = 0;
+    size_t offset_ = 0;
+    size_t scopes_ = 0;
+};
+
+/**
+ * arena() - The calling thread's arena
+ */
+Arena& arena();
+
+/**
+ * allocate_object() - Memory for an object of @p size bytes, from the calling thread's arena while it is in a scope and
+ * from the heap otherwise
+ */
+void* allocate_object(size_t size);
+
+/**
+ * deallocate_object() - Frees memory from allocate_object() if it came from the heap; arena memory comes back when the
+ * arena is rewound
+ */
+void deallocate_object(void* ptr);
+
+/**
+ * Allocator placing standard containers in the calling thread's arena, see allocate_object()
+ */
+template<typename T>
+struct ArenaAllocator
+{
+    using value_type = T;
+
+    ArenaAllocator() = default;
+
+    template<typename U>
+    explicit ArenaAllocator(const ArenaAllocator<U>&) {}
+
+    static_assert(alignof(T) <= alignof(std::max_align_t));
+
+    T* allocate(const size_t n) { return static_cast<T*>(allocate_object(n * sizeof(T))); }
+    void deallocate(T* ptr, size_t) { deallocate_object(ptr); }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U>&) const { return true; }
+};
+}
+
+#endif //ABII_ARENA_H
@@ -42,20 +42,20 @@ struct ArgPrinter final : VirtArgPrinter
     template <typename V>
     [[nodiscard]] std::string enum_printer(V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
@@ -67,17 +67,19 @@ struct ArgPrinter final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << arg_;
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(arg_);
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return); }
+    [[nodiscard]] bool is_error() const override { return error_value(arg_); }
+    bool snapshot(std::string& bytes) const override { return snapshot_arg(arg_, bytes); }
 
-    ArgPrinter(T& arg, const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
+    ArgPrinter(T& arg, const std::string& name, const size_t previous_depth, const PrinterConfig* config,
                std::ostream* os = &abii_stream, const int flags = 1) : arg_(arg), name_(name),
-                                                                       enum_printers_(enum_printers),
+                                                                       config_(config),
                                                                        depth_(previous_depth + 1),
                                                                        print_endl_(flags & PRINT_ENDL), os_(os) {}
 
@@ -85,7 +87,7 @@ private:
     T& arg_;
     T rval_arg_;
     std::string name_;
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
+    PrinterConfigRef config_;
     size_t depth_ = 0;
     bool print_endl_ = true;
     std::ostream* os_;
@@ -116,20 +118,20 @@ struct ArgPrinter<const T>final : VirtArgPrinter
     template <typename V>
     [[nodiscard]] std::string enum_printer(V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
@@ -141,18 +143,20 @@ struct ArgPrinter<const T>final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << arg_;
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(arg_);
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return); }
+    [[nodiscard]] bool is_error() const override { return error_value(arg_); }
+    bool snapshot(std::string& bytes) const override { return snapshot_arg(arg_, bytes); }
 
     // internal usage
-    ArgPrinter(const T& arg, const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
+    ArgPrinter(const T& arg, const std::string& name, const size_t previous_depth, const PrinterConfig* config,
                std::ostream* os = &abii_stream, const int flags = 1) : arg_(arg), name_(name),
-                                                                       enum_printers_(enum_printers),
+                                                                       config_(config),
                                                                        depth_(previous_depth + 1),
                                                                        print_endl_(flags & PRINT_ENDL), os_(os) {}
 
@@ -160,7 +164,7 @@ private:
     const T& arg_;
     const T rval_arg_ = arg_;
     std::string name_;
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
+    PrinterConfigRef config_;
     size_t depth_ = 0;
     bool print_endl_ = true;
     std::ostream* os_;
@@ -178,8 +182,8 @@ private:
 template <typename T>
 void ArgPrinter<T>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << arg_;
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(arg_);
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (print_endl_)
         *os_ << std::endl;
@@ -191,9 +195,9 @@ void ArgPrinter<T>::print_arg()
 template <>
 inline void ArgPrinter<char>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << static_cast<unsigned int>(static_cast<unsigned char>(
-        arg_));
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") "
+         << formatted(static_cast<unsigned int>(static_cast<unsigned char>(arg_)));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (arg_ == 8)
         *os_ << " {BS}";
@@ -212,8 +216,8 @@ inline void ArgPrinter<char>::print_arg()
 template <>
 inline void ArgPrinter<wchar_t>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << static_cast<unsigned int>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(static_cast<unsigned int>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (arg_ == 8)
         *os_ << " {BS}";
@@ -232,8 +236,8 @@ inline void ArgPrinter<wchar_t>::print_arg()
 template <>
 inline void ArgPrinter<unsigned char>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << static_cast<unsigned int>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(static_cast<unsigned int>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (arg_ == 8)
         *os_ << " {BS}";
@@ -269,8 +273,8 @@ inline void ArgPrinter<pre_fmtd_str>::print_arg()
 template <typename T>
 void ArgPrinter<const T>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << arg_;
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(arg_);
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
 
     if (print_endl_)
@@ -283,9 +287,9 @@ void ArgPrinter<const T>::print_arg()
 template <>
 inline void ArgPrinter<const char>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << static_cast<unsigned int>(static_cast<unsigned char>(
-        arg_));
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") "
+         << formatted(static_cast<unsigned int>(static_cast<unsigned char>(arg_)));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (arg_ == 8)
         *os_ << " {BS}";
@@ -304,9 +308,9 @@ inline void ArgPrinter<const char>::print_arg()
 template <>
 inline void ArgPrinter<const wchar_t>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << static_cast<unsigned int>(static_cast<unsigned char>(
-        arg_));
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") "
+         << formatted(static_cast<unsigned int>(static_cast<unsigned char>(arg_)));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (arg_ == 8)
         *os_ << " {BS}";
@@ -325,8 +329,8 @@ inline void ArgPrinter<const wchar_t>::print_arg()
 template <>
 inline void ArgPrinter<const unsigned char>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << static_cast<unsigned int>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(static_cast<unsigned int>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (arg_ == 8)
         *os_ << " {BS}";
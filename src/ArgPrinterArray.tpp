@@ -31,10 +31,10 @@ struct ArgPrinter<T[N]>final : VirtArgPrinter
     void set_name(const std::string& name) override { name_ = name; }
 
     template <typename V>
-    [[nodiscard]] V get_len() const { return len_->get_ref(); }
+    [[nodiscard]] V get_len() const { return len_.get_ref(); }
 
     template <typename V>
-    void set_len(V& len) { len_ = new Reference<V>(len); }
+    void set_len(V& len) { len_ = Reference(len); }
 
     [[nodiscard]] std::string get_fmt() const { return fmt_; }
     void set_fmt(const std::string& fmt) { fmt_ = fmt; }
@@ -42,38 +42,40 @@ struct ArgPrinter<T[N]>final : VirtArgPrinter
     template <typename V>
     [[nodiscard]] std::string enum_printer(V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
 
     [[nodiscard]] std::string va_list_printer(const char* fmt, va_list args, const size_t size = 0) const
     {
-        return va_list_printers_.contains(depth_) ? va_list_printers_.find(depth_)->second(fmt, args, size) : "";
+        const auto printer = config_.va_list_printer(depth_);
+        return printer != nullptr ? (*printer)(fmt, args, size) : "";
     }
 
     [[nodiscard]] std::function<std::string(const char*, va_list, size_t)> get_va_list_printer() const
     {
-        return va_list_printers_.contains(depth_) ? va_list_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.va_list_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     void set_va_list_printer(const std::function<std::string(const char*, va_list, size_t)>& va_list_printer,
                              const size_t size = 0)
     {
-        va_list_printers_.insert({
+        config_.edit().va_list_printers.insert({
             depth_,
             [va_list_printer](const char* fmt, va_list args, const size_t size) -> std::string
             {
@@ -92,27 +94,31 @@ struct ArgPrinter<T[N]>final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << arg_;
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(arg_);
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return); }
 
-    ArgPrinter(T (&arg)[N], const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
+    bool snapshot(std::string& bytes) const override
+    {
+        return fmt_.empty() && !config_.has_va_list_printers() && snapshot_arg(arg_, bytes);
+    }
+
+    ArgPrinter(T (&arg)[N], const std::string& name, const size_t previous_depth, const PrinterConfig* config,
                std::ostream* os = &abii_stream, const int flags = 1)
-        : arg_(arg), name_(name), enum_printers_(enum_printers), depth_(previous_depth + 1),
+        : arg_(arg), name_(name), config_(config), depth_(previous_depth + 1),
           print_endl_(flags & PRINT_ENDL), recurse_(flags & RECURSE), os_(os) {}
 
 private:
     T (&arg_)[N];
     T rval_arg_[N];
     std::string name_{};
-    ReferenceType* len_ = new Reference(def_len_);
+    Reference len_{def_len_};
     std::string fmt_{};
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
-    std::map<size_t, std::function<std::string(const char*, va_list, size_t)>> va_list_printers_;
+    PrinterConfigRef config_;
     size_t va_list_printer_buf_size_ = 0;
     size_t depth_ = 0;
     bool print_endl_ = true;
@@ -146,28 +152,28 @@ struct ArgPrinter<__locale_data* const[N]>final : VirtArgPrinter
     void set_name(const std::string& name) override { name_ = name; }
 
     template <typename V>
-    [[nodiscard]] V get_len() const { return len_->get_ref(); }
+    [[nodiscard]] V get_len() const { return len_.get_ref(); }
 
     template <typename V>
-    void set_len(V& len) { len_ = new Reference<V>(len); }
+    void set_len(V& len) { len_ = Reference(len); }
 
     template <typename V>
     [[nodiscard]] std::string enum_printer(V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
@@ -181,25 +187,25 @@ struct ArgPrinter<__locale_data* const[N]>final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << arg_;
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(arg_);
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return); }
 
     ArgPrinter(__locale_data* const (&arg)[N], const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
-               std::ostream* os = &abii_stream, const int flags = 1)
-        : arg_(arg), name_(name), enum_printers_(enum_printers), depth_(previous_depth + 1),
+               const PrinterConfig* config, std::ostream* os = &abii_stream, const int flags = 1)
+        : arg_(arg), name_(name), config_(config), depth_(previous_depth + 1),
           print_endl_(flags & PRINT_ENDL), recurse_(flags & RECURSE), os_(os) {}
 
 private:
     __locale_data* const (&arg_)[N];
     __locale_data* const rval_arg_[N] = nullptr;
     std::string name_;
-    ReferenceType* len_ = new Reference(def_len_);
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
+    Reference len_{def_len_};
+    PrinterConfigRef config_;
     size_t depth_ = 0;
     bool print_endl_ = true;
     bool recurse_ = true;
@@ -232,28 +238,28 @@ struct ArgPrinter<const T[N]>final : VirtArgPrinter
     void set_name(const std::string& name) override { name_ = name; }
 
     template <typename V>
-    [[nodiscard]] V get_len() const { return len_->get_ref(); }
+    [[nodiscard]] V get_len() const { return len_.get_ref(); }
 
     template <typename V>
-    void set_len(V& len) { len_ = new Reference<V>(len); }
+    void set_len(V& len) { len_ = Reference(len); }
 
     template <typename V>
     [[nodiscard]] std::string enum_printer(V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
@@ -267,25 +273,30 @@ struct ArgPrinter<const T[N]>final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << arg_;
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(arg_);
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return); }
 
-    ArgPrinter(const T (&arg)[N], const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
+    bool snapshot(std::string& bytes) const override
+    {
+        return !config_.has_va_list_printers() && snapshot_arg(arg_, bytes);
+    }
+
+    ArgPrinter(const T (&arg)[N], const std::string& name, const size_t previous_depth, const PrinterConfig* config,
                std::ostream* os = &abii_stream, const int flags = 1)
-        : arg_(arg), name_(name), enum_printers_(enum_printers), depth_(previous_depth + 1),
+        : arg_(arg), rval_arg_(), name_(name), config_(config), depth_(previous_depth + 1),
           print_endl_(flags & PRINT_ENDL), recurse_(flags & RECURSE), os_(os) {}
 
 private:
     const T (&arg_)[N];
     const T rval_arg_[N];
     std::string name_;
-    ReferenceType* len_ = new Reference(def_len_);
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
+    Reference len_{def_len_};
+    PrinterConfigRef config_;
     size_t depth_ = 0;
     bool print_endl_ = true;
     bool recurse_ = true;
@@ -317,28 +328,28 @@ struct ArgPrinter<T[0]>final : VirtArgPrinter
     void set_name(const std::string& name) override { name_ = name; }
 
     template <typename V>
-    [[nodiscard]] V get_len() const { return len_->get_ref(); }
+    [[nodiscard]] V get_len() const { return len_.get_ref(); }
 
     template <typename V>
-    void set_len(V& len) { len_ = new Reference<V>(len); }
+    void set_len(V& len) { len_ = Reference(len); }
 
     template <typename V>
     [[nodiscard]] std::string enum_printer(V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
@@ -350,25 +361,25 @@ struct ArgPrinter<T[0]>final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << arg_;
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(arg_);
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return); }
 
-    ArgPrinter(T (&arg)[0], const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
+    ArgPrinter(T (&arg)[0], const std::string& name, const size_t previous_depth, const PrinterConfig* config,
                std::ostream* os = &abii_stream, const int flags = 1)
-        : arg_(arg), name_(name), enum_printers_(enum_printers), depth_(previous_depth + 1),
+        : arg_(arg), name_(name), config_(config), depth_(previous_depth + 1),
           print_endl_(flags & PRINT_ENDL), os_(os) {}
 
 private:
     T (&arg_)[0];
     T rval_arg_[0];
     std::string name_;
-    ReferenceType* len_ = new Reference(def_len_);
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
+    Reference len_{def_len_};
+    PrinterConfigRef config_;
     size_t depth_ = 0;
     bool print_endl_ = true;
     std::ostream* os_;
@@ -399,28 +410,28 @@ struct ArgPrinter<const T[0]>final : VirtArgPrinter
     void set_name(const std::string& name) override { name_ = name; }
 
     template <typename V>
-    [[nodiscard]] V get_len() const { return len_->get_ref(); }
+    [[nodiscard]] V get_len() const { return len_.get_ref(); }
 
     template <typename V>
-    void set_len(V& len) { len_ = new Reference<V>(len); }
+    void set_len(V& len) { len_ = Reference(len); }
 
     template <typename V>
     [[nodiscard]] std::string enum_printer(V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
@@ -432,25 +443,25 @@ struct ArgPrinter<const T[0]>final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << arg_;
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(arg_);
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return); }
 
-    ArgPrinter(const T (&arg)[0], const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
+    ArgPrinter(const T (&arg)[0], const std::string& name, const size_t previous_depth, const PrinterConfig* config,
                std::ostream* os = &abii_stream, const int flags = 1)
-        : arg_(arg), name_(name), enum_printers_(enum_printers), depth_(previous_depth + 1),
+        : arg_(arg), name_(name), config_(config), depth_(previous_depth + 1),
           print_endl_(flags & PRINT_ENDL), os_(os) {}
 
 private:
     const T (&arg_)[0];
     const T rval_arg_[0];
     std::string name_;
-    ReferenceType* len_ = new Reference(def_len_);
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
+    Reference len_{def_len_};
+    PrinterConfigRef config_;
     size_t depth_ = 0;
     bool print_endl_ = true;
     std::ostream* os_;
@@ -473,32 +484,26 @@ size_t ArgPrinter<const T[0]>::def_len_ = 0;
 template <typename T, size_t N>
 void ArgPrinter<T[N]>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
-    if (recurse_ && bomb_detector(arg_, len_->get_ref()))
+    if (recurse_ && bomb_detector(arg_, len_.get_ref()))
     {
-        *os_ << std::endl;
         const auto old_prefix = prefix;
         prefix += "\t";
-        if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-            *os_ << prefix << "[RECURSION]";
-        else
+        if (enter_address(*os_, arg_))
         {
-            used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
             for (auto i = 0; i < N; ++i)
             {
-                std::stringstream ss;
-                ss << name_ << "[" << i << "]";
-                auto next = new ArgPrinter<T>(arg_[i], ss.str(), depth_, enum_printers_, os_);
+                ArgPrinter<T> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
                 if (i == N - 1)
-                    next->set_print_endl(false);
+                    next.set_print_endl(false);
 
-                next->print_arg();
+                next.print_arg();
             }
-            used_addrs.pop_back();
+            leave_address();
         }
         prefix = old_prefix;
     }
@@ -507,18 +512,28 @@ void ArgPrinter<T[N]>::print_arg()
 }
 
 #ifndef BIT32
+/**
+ * ArgPrinter<va_list>::snapshot() - va_list arguments are printed through their format, so they are always re-rendered
+ *
+ * Specialized so that snapshot_arg() is never instantiated for __va_list_tag, whose attributes it would warn about.
+ */
+template <>
+inline bool ArgPrinter<va_list>::snapshot(std::string&) const
+{
+    return false;
+}
+
 template <>
 inline void ArgPrinter<va_list>::print_arg()
 {
     *os_ << prefix << name_ << ": (" << get_type(arg_) << ")";
-    if (enum_printers_.contains(depth_))
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     const auto old_prefix = prefix;
     prefix += "\t";
-    std::stringstream ss;
-    ss << va_list_printer(fmt_.c_str(), arg_, va_list_printer_buf_size_);
+    auto str = va_list_printer(fmt_.c_str(), arg_, va_list_printer_buf_size_);
     prefix = old_prefix;
-    if (std::string str = ss.str(); !str.empty())
+    if (!str.empty())
     {
         if (!print_endl_)
             str.pop_back();
@@ -541,32 +556,26 @@ inline void ArgPrinter<va_list>::print_arg()
 template <typename T, size_t N>
 void ArgPrinter<const T[N]>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<const void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<const void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
-    if (recurse_ && bomb_detector(arg_, len_->get_ref()))
+    if (recurse_ && bomb_detector(arg_, len_.get_ref()))
     {
-        *os_ << std::endl;
         const auto old_prefix = prefix;
         prefix += "\t";
-        if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-            *os_ << prefix << "[RECURSION]";
-        else
+        if (enter_address(*os_, arg_))
         {
-            used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
             for (auto i = 0; i < N; ++i)
             {
-                std::stringstream ss;
-                ss << name_ << "[" << i << "]";
-                auto next = new ArgPrinter<const T>(arg_[i], ss.str(), depth_, enum_printers_, os_);
+                ArgPrinter<const T> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
                 if (i == N - 1)
-                    next->set_print_endl(false);
+                    next.set_print_endl(false);
 
-                next->print_arg();
+                next.print_arg();
             }
-            used_addrs.pop_back();
+            leave_address();
         }
         prefix = old_prefix;
     }
@@ -577,32 +586,26 @@ void ArgPrinter<const T[N]>::print_arg()
 template <size_t N>
 void ArgPrinter<__locale_data* const[N]>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
-    if (recurse_ && bomb_detector(arg_, len_->get_ref()))
+    if (recurse_ && bomb_detector(arg_, len_.get_ref()))
     {
-        *os_ << std::endl;
         const auto old_prefix = prefix;
         prefix += "\t";
-        if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-            *os_ << prefix << "[RECURSION]";
-        else
+        if (enter_address(*os_, arg_))
         {
-            used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
             for (auto i = 0; i < N; ++i)
             {
-                std::stringstream ss;
-                ss << name_ << "[" << i << "]";
-                auto next = new ArgPrinter<void* const>(arg_[i], ss.str(), depth_, enum_printers_, os_);
+                ArgPrinter<void* const> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
                 if (i == N - 1)
-                    next->set_print_endl(false);
+                    next.set_print_endl(false);
 
-                next->print_arg();
+                next.print_arg();
             }
-            used_addrs.pop_back();
+            leave_address();
         }
         prefix = old_prefix;
     }
@@ -622,8 +625,8 @@ void ArgPrinter<__locale_data* const[N]>::print_arg()
 template <typename T>
 void ArgPrinter<T[0]>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (print_endl_)
         *os_ << std::endl;
@@ -641,8 +644,8 @@ void ArgPrinter<T[0]>::print_arg()
 template <typename T>
 void ArgPrinter<const T[0]>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<const void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<const void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (print_endl_)
         *os_ << std::endl;
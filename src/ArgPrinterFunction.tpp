@@ -33,20 +33,20 @@ struct ArgPrinter<Ret(*)(Args...)>final : VirtArgPrinter
     template <typename V>
     [[nodiscard]] std::string enum_printer(V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
@@ -58,24 +58,25 @@ struct ArgPrinter<Ret(*)(Args...)>final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << arg_;
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(arg_);
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return); }
+    bool snapshot(std::string& bytes) const override { return snapshot_arg(arg_, bytes); }
 
-    ArgPrinter(ArgPrinterFunc& arg, const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
+    ArgPrinter(ArgPrinterFunc& arg, const std::string& name, const size_t previous_depth, const PrinterConfig* config,
                std::ostream* os = &abii_stream, const int flags = 1)
-        : arg_(arg), name_(name), enum_printers_(enum_printers), depth_(previous_depth + 1),
+        : arg_(arg), name_(name), config_(config), depth_(previous_depth + 1),
           print_endl_(flags & PRINT_ENDL), os_(os) {}
 
 private:
     ArgPrinterFunc& arg_;
     ArgPrinterFunc rval_arg_ = nullptr;
     std::string name_{};
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
+    PrinterConfigRef config_;
     size_t depth_ = 0;
     bool print_endl_ = true;
     std::ostream* os_;
@@ -107,20 +108,20 @@ struct ArgPrinter<Ret(* const)(Args...)>final : VirtArgPrinter
     template <typename V>
     [[nodiscard]] std::string enum_printer(V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
@@ -132,24 +133,25 @@ struct ArgPrinter<Ret(* const)(Args...)>final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << arg_;
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(arg_);
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return); }
+    bool snapshot(std::string& bytes) const override { return snapshot_arg(arg_, bytes); }
 
     ArgPrinter(ArgPrinterFunc const& arg, const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
-               std::ostream* os = &abii_stream, const int flags = 1)
-        : arg_(arg), name_(name), enum_printers_(enum_printers), depth_(previous_depth + 1),
+               const PrinterConfig* config, std::ostream* os = &abii_stream, const int flags = 1)
+        : arg_(arg), name_(name), config_(config), depth_(previous_depth + 1),
           print_endl_(flags & PRINT_ENDL), os_(os) {}
 
 private:
     ArgPrinterFunc const& arg_;
     ArgPrinterFunc const rval_arg_ = nullptr;
     std::string name_{};
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
+    PrinterConfigRef config_;
     size_t depth_ = 0;
     bool print_endl_ = true;
     std::ostream* os_;
@@ -161,8 +163,8 @@ private:
 template <typename Ret, typename... Args>
 void ArgPrinter<Ret(*)(Args...)>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (const auto name = get_symbol_name(reinterpret_cast<void*>(arg_)); !name.empty())
         *os_ << " (" << name << ")";
@@ -176,8 +178,8 @@ void ArgPrinter<Ret(*)(Args...)>::print_arg()
 template <typename Ret, typename... Args>
 void ArgPrinter<Ret(* const)(Args...)>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (const auto name = get_symbol_name(reinterpret_cast<void*>(arg_)); !name.empty())
         *os_ << " (" << name << ")";
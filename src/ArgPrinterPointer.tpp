@@ -32,53 +32,59 @@ struct ArgPrinter<T*>final : VirtArgPrinter
     void set_name(const std::string& name) override { name_ = name; }
 
     template <typename V>
-    [[nodiscard]] V get_len() const { return len_->get_ref(); }
+    [[nodiscard]] V get_len() const { return len_.get_ref(); }
 
     template <typename V>
-    void set_len(V& len) { len_ = new Reference<V>(len); }
+    void set_len(V& len) { len_ = Reference(len); }
 
     [[nodiscard]] std::string get_fmt() const { return fmt_; }
     void set_fmt(const std::string& fmt) { fmt_ = fmt; }
 
     [[nodiscard]] std::function<bool(size_t)> get_end_test() const { return end_test_; }
 
-    void set_end_test(const std::function<bool(size_t)>& end_test) { end_test_ = end_test; }
+    void set_end_test(const std::function<bool(size_t)>& end_test)
+    {
+        end_test_ = end_test;
+        custom_end_test_ = true;
+    }
 
     template <typename V>
     [[nodiscard]] std::string enum_printer(V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
 
     [[nodiscard]] std::string va_list_printer(const char* fmt, va_list args, const size_t size = 0) const
     {
-        return va_list_printers_.contains(depth_) ? va_list_printers_.find(depth_)->second(fmt, args, size) : "";
+        const auto printer = config_.va_list_printer(depth_);
+        return printer != nullptr ? (*printer)(fmt, args, size) : "";
     }
 
     [[nodiscard]] std::function<std::string(const char*, va_list, size_t)> get_va_list_printer() const
     {
-        return va_list_printers_.contains(depth_) ? va_list_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.va_list_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     void set_va_list_printer(const std::function<std::string(const char*, va_list, size_t)>& va_list_printer,
                              const size_t size = 0)
     {
-        va_list_printers_.insert({
+        config_.edit().va_list_printers.insert({
             depth_,
             [va_list_printer](const char* fmt, va_list args, const size_t size) -> std::string
             {
@@ -97,28 +103,36 @@ struct ArgPrinter<T*>final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << arg_;
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(arg_);
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return, len_.get_ref()); }
+    void capture_after() const override { trace_arg(arg_, name_, false, len_.get_ref(), TF_AFTER); }
+    [[nodiscard]] bool is_error() const override { return error_value(arg_); }
+    [[nodiscard]] size_t buffer_bytes() const override { return abii::buffer_bytes<T>(len_.get_ref()); }
+    bool snapshot(std::string& bytes) const override
+    {
+        return !custom_end_test_ && fmt_.empty() && !config_.has_va_list_printers() &&
+               snapshot_arg(arg_, bytes, len_.get_ref());
+    }
 
-    ArgPrinter(T*& arg, const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
+    ArgPrinter(T*& arg, const std::string& name, const size_t previous_depth, const PrinterConfig* config,
                std::ostream* os = &abii_stream, const int flags = 1)
-        : arg_(arg), name_(name), enum_printers_(enum_printers), depth_(previous_depth + 1),
+        : arg_(arg), name_(name), config_(config), depth_(previous_depth + 1),
           print_endl_(flags & PRINT_ENDL), recurse_(flags & RECURSE), os_(os) {}
 
 private:
     T*& arg_;
     T* rval_arg_ = nullptr;
     std::string name_;
-    ReferenceType* len_ = new Reference(def_len_);
+    Reference len_{def_len_};
     std::string fmt_;
-    std::function<bool(size_t)> end_test_ = [&](const int i) { return i < len_->get_ref(); };
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
-    std::map<size_t, std::function<std::string(const char*, va_list, size_t)>> va_list_printers_;
+    std::function<bool(size_t)> end_test_ = [&](const int i) { return i < len_.get_ref(); };
+    bool custom_end_test_ = false;
+    PrinterConfigRef config_;
     size_t va_list_printer_buf_size_ = 0;
     size_t depth_ = 0;
     bool print_endl_ = true;
@@ -154,32 +168,36 @@ struct ArgPrinter<const T*>final : VirtArgPrinter
     void set_name(const std::string& name) override { name_ = name; }
 
     template <typename V>
-    [[nodiscard]] V get_len() const { return len_->get_ref(); }
+    [[nodiscard]] V get_len() const { return len_.get_ref(); }
 
     template <typename V>
-    void set_len(V& len) { len_ = new Reference<V>(len); }
+    void set_len(V& len) { len_ = Reference(len); }
 
     [[nodiscard]] std::function<bool(size_t)> get_end_test() const { return end_test_; }
 
-    void set_end_test(const std::function<bool(size_t)>& end_test) { end_test_ = end_test; }
+    void set_end_test(const std::function<bool(size_t)>& end_test)
+    {
+        end_test_ = end_test;
+        custom_end_test_ = true;
+    }
 
     template <typename V>
     [[nodiscard]] std::string enum_printer(const V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
@@ -193,26 +211,33 @@ struct ArgPrinter<const T*>final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << reinterpret_cast<const void*>(arg_);
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(reinterpret_cast<const void*>(arg_));
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return, len_.get_ref()); }
+    [[nodiscard]] bool is_error() const override { return error_value(arg_); }
+    [[nodiscard]] size_t buffer_bytes() const override { return abii::buffer_bytes<T>(len_.get_ref()); }
+    bool snapshot(std::string& bytes) const override
+    {
+        return !custom_end_test_ && !config_.has_va_list_printers() && snapshot_arg(arg_, bytes, len_.get_ref());
+    }
 
-    ArgPrinter(const T*& arg, const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
+    ArgPrinter(const T*& arg, const std::string& name, const size_t previous_depth, const PrinterConfig* config,
                std::ostream* os = &abii_stream, const int flags = 1)
-        : arg_(arg), name_(name), enum_printers_(enum_printers), depth_(previous_depth + 1),
+        : arg_(arg), name_(name), config_(config), depth_(previous_depth + 1),
           print_endl_(flags & PRINT_ENDL), recurse_(flags & RECURSE), os_(os) {}
 
 private:
     const T*& arg_;
     const T* rval_arg_ = nullptr;
     std::string name_;
-    ReferenceType* len_ = new Reference(def_len_);
-    std::function<bool(size_t)> end_test_ = [&](const int i) { return i < len_->get_ref(); };
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
+    Reference len_{def_len_};
+    std::function<bool(size_t)> end_test_ = [&](const int i) { return i < len_.get_ref(); };
+    bool custom_end_test_ = false;
+    PrinterConfigRef config_;
     size_t depth_ = 0;
     bool print_endl_ = true;
     bool recurse_ = true;
@@ -247,32 +272,36 @@ struct ArgPrinter<T* const>final : VirtArgPrinter
     void set_name(const std::string& name) override { name_ = name; }
 
     template <typename V>
-    [[nodiscard]] V get_len() const { return len_->get_ref(); }
+    [[nodiscard]] V get_len() const { return len_.get_ref(); }
 
     template <typename V>
-    void set_len(V& len) { len_ = new Reference<V>(len); }
+    void set_len(V& len) { len_ = Reference(len); }
 
     [[nodiscard]] std::function<bool(size_t)> get_end_test() const { return end_test_; }
 
-    void set_end_test(const std::function<bool(size_t)>& end_test) { end_test_ = end_test; }
+    void set_end_test(const std::function<bool(size_t)>& end_test)
+    {
+        end_test_ = end_test;
+        custom_end_test_ = true;
+    }
 
     template <typename V>
     [[nodiscard]] std::string enum_printer(V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
@@ -286,26 +315,34 @@ struct ArgPrinter<T* const>final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << reinterpret_cast<void*>(arg_);
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(reinterpret_cast<void*>(arg_));
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return, len_.get_ref()); }
+    void capture_after() const override { trace_arg(arg_, name_, false, len_.get_ref(), TF_AFTER); }
+    [[nodiscard]] bool is_error() const override { return error_value(arg_); }
+    [[nodiscard]] size_t buffer_bytes() const override { return abii::buffer_bytes<T>(len_.get_ref()); }
+    bool snapshot(std::string& bytes) const override
+    {
+        return !custom_end_test_ && !config_.has_va_list_printers() && snapshot_arg(arg_, bytes, len_.get_ref());
+    }
 
-    ArgPrinter(T* const& arg, const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
+    ArgPrinter(T* const& arg, const std::string& name, const size_t previous_depth, const PrinterConfig* config,
                std::ostream* os = &abii_stream, const int flags = 1)
-        : arg_(arg), name_(name), enum_printers_(enum_printers), depth_(previous_depth + 1),
+        : arg_(arg), name_(name), config_(config), depth_(previous_depth + 1),
           print_endl_(flags & PRINT_ENDL), recurse_(flags & RECURSE), os_(os) {}
 
 private:
     T* const& arg_;
     T* const rval_arg_ = nullptr;
     std::string name_;
-    ReferenceType* len_ = new Reference(def_len_);
-    std::function<bool(size_t)> end_test_ = [&](const int i) { return i < len_->get_ref(); };
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
+    Reference len_{def_len_};
+    std::function<bool(size_t)> end_test_ = [&](const int i) { return i < len_.get_ref(); };
+    bool custom_end_test_ = false;
+    PrinterConfigRef config_;
     size_t depth_ = 0;
     bool print_endl_ = true;
     bool recurse_ = true;
@@ -340,32 +377,36 @@ struct ArgPrinter<const T* const>final : VirtArgPrinter
     void set_name(const std::string& name) override { name_ = name; }
 
     template <typename V>
-    [[nodiscard]] V get_len() const { return len_->get_ref(); }
+    [[nodiscard]] V get_len() const { return len_.get_ref(); }
 
     template <typename V>
-    void set_len(V& len) { len_ = new Reference<V>(len); }
+    void set_len(V& len) { len_ = Reference(len); }
 
     [[nodiscard]] std::function<bool(size_t)> get_end_test() const { return end_test_; }
 
-    void set_end_test(const std::function<bool(size_t)>& end_test) { end_test_ = end_test; }
+    void set_end_test(const std::function<bool(size_t)>& end_test)
+    {
+        end_test_ = end_test;
+        custom_end_test_ = true;
+    }
 
     template <typename V>
     [[nodiscard]] std::string enum_printer(V& arg) const
     {
-        return enum_printers_.contains(depth_)
-                   ? enum_printers_.find(depth_)->second(reinterpret_cast<const void*>(&arg))
-                   : "";
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? (*printer)(reinterpret_cast<const void*>(&arg)) : "";
     }
 
     [[nodiscard]] std::function<std::string(void*)> get_enum_printer() const
     {
-        return enum_printers_.contains(depth_) ? enum_printers_.find(depth_)->second : nullptr;
+        const auto printer = config_.enum_printer(depth_);
+        return printer != nullptr ? *printer : nullptr;
     }
 
     template <typename V>
     void set_enum_printer_(const std::function<std::string(V)>& enum_printer, size_t depth = 0)
     {
-        enum_printers_.insert({
+        config_.edit().enum_printers.insert({
             depth, [enum_printer](const void* arg) -> std::string { return enum_printer(*static_cast<const V*>(arg)); }
         });
     }
@@ -379,26 +420,33 @@ struct ArgPrinter<const T* const>final : VirtArgPrinter
 
     [[nodiscard]] std::string get_value() const override
     {
-        std::stringstream ss;
-        ss << reinterpret_cast<const void*>(arg_);
-        return ss.str();
+        ScratchStream ss;
+        *ss << formatted(reinterpret_cast<const void*>(arg_));
+        return ss->str();
     }
 
     void print_arg() override;
+    void capture(const bool is_return) const override { trace_arg(arg_, name_, is_return, len_.get_ref()); }
+    [[nodiscard]] bool is_error() const override { return error_value(arg_); }
+    [[nodiscard]] size_t buffer_bytes() const override { return abii::buffer_bytes<T>(len_.get_ref()); }
+    bool snapshot(std::string& bytes) const override
+    {
+        return !custom_end_test_ && !config_.has_va_list_printers() && snapshot_arg(arg_, bytes, len_.get_ref());
+    }
 
-    ArgPrinter(const T* const& arg, const std::string& name, const size_t previous_depth,
-               const std::map<size_t, std::function<std::string(const void*)>>& enum_printers,
+    ArgPrinter(const T* const& arg, const std::string& name, const size_t previous_depth, const PrinterConfig* config,
                std::ostream* os = &abii_stream, const int flags = 1)
-        : arg_(arg), name_(name), enum_printers_(enum_printers), depth_(previous_depth + 1),
+        : arg_(arg), name_(name), config_(config), depth_(previous_depth + 1),
           print_endl_(flags & PRINT_ENDL), recurse_(flags & RECURSE), os_(os) {}
 
 private:
     const T* const& arg_;
     const T* const rval_arg_ = nullptr;
     std::string name_;
-    ReferenceType* len_ = new Reference(def_len_);
-    std::function<bool(size_t)> end_test_ = [&](const int i) { return i < len_->get_ref(); };
-    std::map<size_t, std::function<std::string(const void*)>> enum_printers_;
+    Reference len_{def_len_};
+    std::function<bool(size_t)> end_test_ = [&](const int i) { return i < len_.get_ref(); };
+    bool custom_end_test_ = false;
+    PrinterConfigRef config_;
     size_t depth_ = 0;
     bool print_endl_ = true;
     bool recurse_ = true;
@@ -421,42 +469,36 @@ size_t ArgPrinter<const T* const>::def_len_ = 0;
 template <typename T>
 void ArgPrinter<T*>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
     if (const auto name = get_symbol_name(reinterpret_cast<void*>(arg_)); !name.empty())
         *os_ << " (" << name << ")";
-    if (recurse_ && bomb_detector(arg_, len_->get_ref()))
+    if (recurse_ && bomb_detector(arg_, len_.get_ref()))
     {
-        *os_ << std::endl;
         const auto old_prefix = prefix;
         prefix += "\t";
-        if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-            *os_ << prefix << "[RECURSION]";
-        else
+        if (enter_address(*os_, arg_))
         {
-            used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
-            if (len_->get_ref() != 0)
+            if (len_.get_ref() != 0)
                 for (auto i = 0; end_test_(i); ++i)
                 {
-                    std::stringstream ss;
-                    ss << name_ << "[" << i << "]";
-                    const auto next = new ArgPrinter<T>(arg_[i], ss.str(), depth_, enum_printers_, os_);
+                    ArgPrinter<T> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
                     if (!end_test_(i + 1))
-                        next->set_print_endl(false);
+                        next.set_print_endl(false);
 
-                    next->print_arg();
+                    next.print_arg();
                 }
             else
             {
-                const auto next = new ArgPrinter<T>(*arg_, "*" + name_, depth_, enum_printers_, os_);
-                next->set_print_endl(false);
+                ArgPrinter<T> next(*arg_, "*" + name_, depth_, config_.get(), os_);
+                next.set_print_endl(false);
 
-                next->print_arg();
+                next.print_arg();
             }
-            used_addrs.pop_back();
+            leave_address();
         }
         prefix = old_prefix;
     }
@@ -476,10 +518,9 @@ inline void ArgPrinter<char*>::print_arg()
     {
         const auto old_prefix = prefix;
         prefix += "\t";
-        std::stringstream ss;
-        ss << va_list_printer(fmt_.c_str(), arg_, va_list_printer_buf_size_);
+        auto str = va_list_printer(fmt_.c_str(), arg_, va_list_printer_buf_size_);
         prefix = old_prefix;
-        if (std::string str = ss.str(); !str.empty())
+        if (!str.empty())
         {
             if (!print_endl_)
                 str.pop_back();
@@ -492,39 +533,33 @@ inline void ArgPrinter<char*>::print_arg()
 
 
 #endif
-    *os_ << " " << reinterpret_cast<void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << " " << formatted(reinterpret_cast<void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
-    if (bomb_detector(arg_, len_->get_ref()))
+    if (const auto len = readable_length(arg_, len_.get_ref()); len != -1)
     {
-        std::string arg = arg_;
+        std::string arg(arg_, len);
         replace_all(arg, "\n", "\\n");
         *os_ << " {" << arg << "}";
         if (recurse_)
         {
-            *os_ << std::endl;
             const auto old_prefix = prefix;
             prefix += "\t";
-            if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-                *os_ << prefix << "[RECURSION]";
-            else
+            if (enter_address(*os_, arg_))
             {
-                used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
-                for (auto i = 0; len_->get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
+                for (auto i = 0; len_.get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
                 {
-                    std::stringstream ss;
-                    ss << name_ << "[" << i << "]";
-                    const auto next = new ArgPrinter<char>(arg_[i], ss.str(), depth_, enum_printers_, os_);
-                    if (i == len_->get_ref() - 1 || (len_->get_ref() == 0 && arg_[i] == 0))
-                        next->set_print_endl(false);
+                    ArgPrinter<char> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
+                    if (i == len_.get_ref() - 1 || (len_.get_ref() == 0 && arg_[i] == 0))
+                        next.set_print_endl(false);
 
-                    next->print_arg();
+                    next.print_arg();
                 }
-                used_addrs.pop_back();
+                leave_address();
             }
             prefix = old_prefix;
         }
@@ -542,39 +577,33 @@ inline void ArgPrinter<char*>::print_arg()
 template <>
 inline void ArgPrinter<wchar_t*>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
-    if (bomb_detector(arg_, len_->get_ref()))
+    if (const auto len = readable_length(arg_, len_.get_ref()); len != -1)
     {
-        auto arg = wide_to_narrow_str(arg_);
+        auto arg = wide_to_narrow_str(std::wstring(arg_, len));
         replace_all(arg, "\n", "\\n");
         *os_ << " {" << arg << "}";
         if (recurse_)
         {
-            *os_ << std::endl;
             const auto old_prefix = prefix;
             prefix += "\t";
-            if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-                *os_ << prefix << "[RECURSION]";
-            else
+            if (enter_address(*os_, arg_))
             {
-                used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
-                for (auto i = 0; len_->get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
+                for (auto i = 0; len_.get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
                 {
-                    std::stringstream ss;
-                    ss << name_ << "[" << i << "]";
-                    const auto next = new ArgPrinter<wchar_t>(arg_[i], ss.str(), depth_, enum_printers_, os_);
-                    if (i == len_->get_ref() - 1 || (len_->get_ref() == 0 && arg_[i] == 0))
-                        next->set_print_endl(false);
+                    ArgPrinter<wchar_t> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
+                    if (i == len_.get_ref() - 1 || (len_.get_ref() == 0 && arg_[i] == 0))
+                        next.set_print_endl(false);
 
-                    next->print_arg();
+                    next.print_arg();
                 }
-                used_addrs.pop_back();
+                leave_address();
             }
             prefix = old_prefix;
         }
@@ -589,8 +618,8 @@ inline void ArgPrinter<wchar_t*>::print_arg()
 template <>
 inline void ArgPrinter<FILE*>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << arg_;
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(arg_);
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
@@ -604,8 +633,8 @@ inline void ArgPrinter<FILE*>::print_arg()
 template <>
 inline void ArgPrinter<DIR*>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << arg_;
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(arg_);
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
@@ -619,8 +648,8 @@ inline void ArgPrinter<DIR*>::print_arg()
 template <>
 inline void ArgPrinter<void*>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << arg_;
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(arg_);
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
@@ -640,42 +669,36 @@ inline void ArgPrinter<void*>::print_arg()
 template <typename T>
 void ArgPrinter<const T*>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<const void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<const void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
     if (const auto name = get_symbol_name(reinterpret_cast<const void*>(arg_)); !name.empty())
         *os_ << " (" << name << ")";
-    if (recurse_ && bomb_detector(arg_, len_->get_ref()))
+    if (recurse_ && bomb_detector(arg_, len_.get_ref()))
     {
-        *os_ << std::endl;
         const auto old_prefix = prefix;
         prefix += "\t";
-        if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-            *os_ << prefix << "[RECURSION]";
-        else
+        if (enter_address(*os_, arg_))
         {
-            used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
-            if (len_->get_ref() != 0)
+            if (len_.get_ref() != 0)
                 for (auto i = 0; end_test_(i); ++i)
                 {
-                    std::stringstream ss;
-                    ss << name_ << "[" << i << "]";
-                    const auto next = new ArgPrinter<const T>(arg_[i], ss.str(), depth_, enum_printers_, os_);
+                    ArgPrinter<const T> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
                     if (!end_test_(i + 1))
-                        next->set_print_endl(false);
+                        next.set_print_endl(false);
 
-                    next->print_arg();
+                    next.print_arg();
                 }
             else
             {
-                const auto next = new ArgPrinter<const T>(*arg_, "*" + name_, depth_, enum_printers_, os_);
-                next->set_print_endl(false);
+                ArgPrinter<const T> next(*arg_, "*" + name_, depth_, config_.get(), os_);
+                next.set_print_endl(false);
 
-                next->print_arg();
+                next.print_arg();
             }
-            used_addrs.pop_back();
+            leave_address();
         }
         prefix = old_prefix;
     }
@@ -689,39 +712,33 @@ void ArgPrinter<const T*>::print_arg()
 template <>
 inline void ArgPrinter<const char*>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<const void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<const void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
-    if (bomb_detector(arg_, len_->get_ref()))
+    if (const auto len = readable_length(arg_, len_.get_ref()); len != -1)
     {
-        std::string arg = arg_;
+        std::string arg(arg_, len);
         replace_all(arg, "\n", "\\n");
         *os_ << " {" << arg << "}";
         if (recurse_)
         {
-            *os_ << std::endl;
             const auto old_prefix = prefix;
             prefix += "\t";
-            if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-                *os_ << prefix << "[RECURSION]";
-            else
+            if (enter_address(*os_, arg_))
             {
-                used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
-                for (auto i = 0; len_->get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
+                for (auto i = 0; len_.get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
                 {
-                    std::stringstream ss;
-                    ss << name_ << "[" << i << "]";
-                    const auto next = new ArgPrinter<const char>(arg_[i], ss.str(), depth_, enum_printers_, os_);
-                    if (i == len_->get_ref() - 1 || (len_->get_ref() == 0 && arg_[i] == 0))
-                        next->set_print_endl(false);
+                    ArgPrinter<const char> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
+                    if (i == len_.get_ref() - 1 || (len_.get_ref() == 0 && arg_[i] == 0))
+                        next.set_print_endl(false);
 
-                    next->print_arg();
+                    next.print_arg();
                 }
-                used_addrs.pop_back();
+                leave_address();
             }
             prefix = old_prefix;
         }
@@ -736,39 +753,33 @@ inline void ArgPrinter<const char*>::print_arg()
 template <>
 inline void ArgPrinter<const wchar_t*>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<const void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<const void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
-    if (bomb_detector(arg_, len_->get_ref()))
+    if (const auto len = readable_length(arg_, len_.get_ref()); len != -1)
     {
-        auto arg = wide_to_narrow_str(arg_);
+        auto arg = wide_to_narrow_str(std::wstring(arg_, len));
         replace_all(arg, "\n", "\\n");
         *os_ << " {" << arg << "}";
         if (recurse_)
         {
-            *os_ << std::endl;
             const auto old_prefix = prefix;
             prefix += "\t";
-            if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-                *os_ << prefix << "[RECURSION]";
-            else
+            if (enter_address(*os_, arg_))
             {
-                used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
-                for (auto i = 0; len_->get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
+                for (auto i = 0; len_.get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
                 {
-                    std::stringstream ss;
-                    ss << name_ << "[" << i << "]";
-                    const auto next = new ArgPrinter<const wchar_t>(arg_[i], ss.str(), depth_, enum_printers_, os_);
-                    if (i == len_->get_ref() - 1 || (len_->get_ref() == 0 && arg_[i] == 0))
-                        next->set_print_endl(false);
+                    ArgPrinter<const wchar_t> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
+                    if (i == len_.get_ref() - 1 || (len_.get_ref() == 0 && arg_[i] == 0))
+                        next.set_print_endl(false);
 
-                    next->print_arg();
+                    next.print_arg();
                 }
-                used_addrs.pop_back();
+                leave_address();
             }
             prefix = old_prefix;
         }
@@ -783,8 +794,8 @@ inline void ArgPrinter<const wchar_t*>::print_arg()
 template <>
 inline void ArgPrinter<const void*>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << arg_;
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(arg_);
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
@@ -804,42 +815,36 @@ inline void ArgPrinter<const void*>::print_arg()
 template <typename T>
 void ArgPrinter<T* const>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
     if (const auto name = get_symbol_name(reinterpret_cast<void*>(arg_)); !name.empty())
         *os_ << " (" << name << ")";
-    if (recurse_ && bomb_detector(arg_, len_->get_ref()))
+    if (recurse_ && bomb_detector(arg_, len_.get_ref()))
     {
-        *os_ << std::endl;
         const auto old_prefix = prefix;
         prefix += "\t";
-        if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-            *os_ << prefix << "[RECURSION]";
-        else
+        if (enter_address(*os_, arg_))
         {
-            used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
-            if (len_->get_ref() != 0)
+            if (len_.get_ref() != 0)
                 for (auto i = 0; end_test_(i); ++i)
                 {
-                    std::stringstream ss;
-                    ss << name_ << "[" << i << "]";
-                    const auto next = new ArgPrinter<T>(arg_[i], ss.str(), depth_, enum_printers_, os_);
+                    ArgPrinter<T> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
                     if (!end_test_(i + 1))
-                        next->set_print_endl(false);
+                        next.set_print_endl(false);
 
-                    next->print_arg();
+                    next.print_arg();
                 }
             else
             {
-                const auto next = new ArgPrinter<T>(*arg_, "*" + name_, depth_, enum_printers_, os_);
-                next->set_print_endl(false);
+                ArgPrinter<T> next(*arg_, "*" + name_, depth_, config_.get(), os_);
+                next.set_print_endl(false);
 
-                next->print_arg();
+                next.print_arg();
             }
-            used_addrs.pop_back();
+            leave_address();
         }
         prefix = old_prefix;
     }
@@ -853,39 +858,33 @@ void ArgPrinter<T* const>::print_arg()
 template <>
 inline void ArgPrinter<char* const>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
-    if (bomb_detector(arg_, len_->get_ref()))
+    if (const auto len = readable_length(arg_, len_.get_ref()); len != -1)
     {
-        std::string arg = arg_;
+        std::string arg(arg_, len);
         replace_all(arg, "\n", "\\n");
         *os_ << " {" << arg << "}";
         if (recurse_)
         {
-            *os_ << std::endl;
             const auto old_prefix = prefix;
             prefix += "\t";
-            if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-                *os_ << prefix << "[RECURSION]";
-            else
+            if (enter_address(*os_, arg_))
             {
-                used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
-                for (auto i = 0; len_->get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
+                for (auto i = 0; len_.get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
                 {
-                    std::stringstream ss;
-                    ss << name_ << "[" << i << "]";
-                    const auto next = new ArgPrinter<char>(arg_[i], ss.str(), depth_, enum_printers_, os_);
-                    if (i == len_->get_ref() - 1 || (len_->get_ref() == 0 && arg_[i] == 0))
-                        next->set_print_endl(false);
+                    ArgPrinter<char> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
+                    if (i == len_.get_ref() - 1 || (len_.get_ref() == 0 && arg_[i] == 0))
+                        next.set_print_endl(false);
 
-                    next->print_arg();
+                    next.print_arg();
                 }
-                used_addrs.pop_back();
+                leave_address();
             }
             prefix = old_prefix;
         }
@@ -900,39 +899,33 @@ inline void ArgPrinter<char* const>::print_arg()
 template <>
 inline void ArgPrinter<wchar_t* const>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
-    if (bomb_detector(arg_, len_->get_ref()))
+    if (const auto len = readable_length(arg_, len_.get_ref()); len != -1)
     {
-        auto arg = wide_to_narrow_str(arg_);
+        auto arg = wide_to_narrow_str(std::wstring(arg_, len));
         replace_all(arg, "\n", "\\n");
         *os_ << " {" << arg << "}";
         if (recurse_)
         {
-            *os_ << std::endl;
             const auto old_prefix = prefix;
             prefix += "\t";
-            if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-                *os_ << prefix << "[RECURSION]";
-            else
+            if (enter_address(*os_, arg_))
             {
-                used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
-                for (auto i = 0; len_->get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
+                for (auto i = 0; len_.get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
                 {
-                    std::stringstream ss;
-                    ss << name_ << "[" << i << "]";
-                    const auto next = new ArgPrinter<wchar_t>(arg_[i], ss.str(), depth_, enum_printers_, os_);
-                    if (i == len_->get_ref() - 1 || (len_->get_ref() == 0 && arg_[i] == 0))
-                        next->set_print_endl(false);
+                    ArgPrinter<wchar_t> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
+                    if (i == len_.get_ref() - 1 || (len_.get_ref() == 0 && arg_[i] == 0))
+                        next.set_print_endl(false);
 
-                    next->print_arg();
+                    next.print_arg();
                 }
-                used_addrs.pop_back();
+                leave_address();
             }
             prefix = old_prefix;
         }
@@ -947,8 +940,8 @@ inline void ArgPrinter<wchar_t* const>::print_arg()
 template <>
 inline void ArgPrinter<FILE* const>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << arg_;
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(arg_);
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
@@ -962,8 +955,8 @@ inline void ArgPrinter<FILE* const>::print_arg()
 template <>
 inline void ArgPrinter<DIR* const>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << arg_;
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(arg_);
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
@@ -977,8 +970,8 @@ inline void ArgPrinter<DIR* const>::print_arg()
 template <>
 inline void ArgPrinter<void* const>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << arg_;
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(arg_);
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
@@ -992,8 +985,8 @@ inline void ArgPrinter<void* const>::print_arg()
 template <>
 inline void ArgPrinter<volatile void* const>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << arg_;
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(arg_);
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (const auto name = get_symbol_name(const_cast<void*>(arg_)); !name.empty())
         *os_ << " (" << name << ")";
@@ -1013,42 +1006,36 @@ inline void ArgPrinter<volatile void* const>::print_arg()
 template <typename T>
 void ArgPrinter<const T* const>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<const void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<const void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
     if (const auto name = get_symbol_name(reinterpret_cast<const void*>(arg_)); !name.empty())
         *os_ << " (" << name << ")";
-    if (recurse_ && bomb_detector(arg_, len_->get_ref()))
+    if (recurse_ && bomb_detector(arg_, len_.get_ref()))
     {
-        *os_ << std::endl;
         const auto old_prefix = prefix;
         prefix += "\t";
-        if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-            *os_ << prefix << "[RECURSION]";
-        else
+        if (enter_address(*os_, arg_))
         {
-            used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
-            if (len_->get_ref() != 0)
+            if (len_.get_ref() != 0)
                 for (auto i = 0; end_test_(i); ++i)
                 {
-                    std::stringstream ss;
-                    ss << name_ << "[" << i << "]";
-                    const auto next = new ArgPrinter<const T>(arg_[i], ss.str(), depth_, enum_printers_, os_);
+                    ArgPrinter<const T> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
                     if (!end_test_(i + 1))
-                        next->set_print_endl(false);
+                        next.set_print_endl(false);
 
-                    next->print_arg();
+                    next.print_arg();
                 }
             else
             {
-                const auto next = new ArgPrinter<const T>(*arg_, "*" + name_, depth_, enum_printers_, os_);
-                next->set_print_endl(false);
+                ArgPrinter<const T> next(*arg_, "*" + name_, depth_, config_.get(), os_);
+                next.set_print_endl(false);
 
-                next->print_arg();
+                next.print_arg();
             }
-            used_addrs.pop_back();
+            leave_address();
         }
         prefix = old_prefix;
     }
@@ -1062,39 +1049,33 @@ void ArgPrinter<const T* const>::print_arg()
 template <>
 inline void ArgPrinter<const char* const>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<const void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<const void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
-    if (bomb_detector(arg_, len_->get_ref()))
+    if (const auto len = readable_length(arg_, len_.get_ref()); len != -1)
     {
-        std::string arg = arg_;
+        std::string arg(arg_, len);
         replace_all(arg, "\n", "\\n");
         *os_ << " {" << arg << "}";
         if (recurse_)
         {
-            *os_ << std::endl;
             const auto old_prefix = prefix;
             prefix += "\t";
-            if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-                *os_ << prefix << "[RECURSION]";
-            else
+            if (enter_address(*os_, arg_))
             {
-                used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
-                for (auto i = 0; len_->get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
+                for (auto i = 0; len_.get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
                 {
-                    std::stringstream ss;
-                    ss << name_ << "[" << i << "]";
-                    const auto next = new ArgPrinter<const char>(arg_[i], ss.str(), depth_, enum_printers_, os_);
-                    if (i == len_->get_ref() - 1 || (len_->get_ref() == 0 && arg_[i] == 0))
-                        next->set_print_endl(false);
+                    ArgPrinter<const char> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
+                    if (i == len_.get_ref() - 1 || (len_.get_ref() == 0 && arg_[i] == 0))
+                        next.set_print_endl(false);
 
-                    next->print_arg();
+                    next.print_arg();
                 }
-                used_addrs.pop_back();
+                leave_address();
             }
             prefix = old_prefix;
         }
@@ -1109,39 +1090,33 @@ inline void ArgPrinter<const char* const>::print_arg()
 template <>
 inline void ArgPrinter<const wchar_t* const>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << reinterpret_cast<const void*>(arg_);
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(reinterpret_cast<const void*>(arg_));
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (depth_ != -1)
         --depth_;
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
-    if (recurse_)
+    if (const auto len = readable_length(arg_, len_.get_ref()); len != -1)
     {
-        *os_ << std::endl;
-        const auto old_prefix = prefix;
-        prefix += "\t";
-        if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) != used_addrs.end())
-            *os_ << prefix << "[RECURSION]";
-        else
+        auto arg = wide_to_narrow_str(std::wstring(arg_, len));
+        replace_all(arg, "\n", "\\n");
+        *os_ << " {" << arg << "}";
+        if (recurse_)
         {
-            auto arg = wide_to_narrow_str(arg_);
-            replace_all(arg, "\n", "\\n");
-            *os_ << " {" << arg << "}";
-            if (std::ranges::find(used_addrs, reinterpret_cast<uintptr_t>(arg_)) == used_addrs.end())
+            const auto old_prefix = prefix;
+            prefix += "\t";
+            if (enter_address(*os_, arg_))
             {
-                used_addrs.push_back(reinterpret_cast<uintptr_t>(arg_));
-                for (auto i = 0; len_->get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
+                for (auto i = 0; len_.get_ref() == 0 ? i == 0 || arg_[i - 1] != 0 : end_test_(i); ++i)
                 {
-                    std::stringstream ss;
-                    ss << name_ << "[" << i << "]";
-                    const auto next = new ArgPrinter<const wchar_t>(arg_[i], ss.str(), depth_, enum_printers_, os_);
-                    if (i == len_->get_ref() - 1 || (len_->get_ref() == 0 && arg_[i] == 0))
-                        next->set_print_endl(false);
+                    ArgPrinter<const wchar_t> next(arg_[i], element_name(name_, i), depth_, config_.get(), os_);
+                    if (i == len_.get_ref() - 1 || (len_.get_ref() == 0 && arg_[i] == 0))
+                        next.set_print_endl(false);
 
-                    next->print_arg();
+                    next.print_arg();
                 }
-                used_addrs.pop_back();
+                leave_address();
             }
             prefix = old_prefix;
         }
@@ -1156,8 +1131,8 @@ inline void ArgPrinter<const wchar_t* const>::print_arg()
 template <>
 inline void ArgPrinter<const void* const>::print_arg()
 {
-    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << arg_;
-    if (enum_printers_.contains(depth_))
+    *os_ << prefix << name_ << ": (" << get_type(arg_) << ") " << formatted(arg_);
+    if (config_.enum_printer(depth_) != nullptr)
         *os_ << " [" << enum_printer(arg_) << "]";
     if (const auto name = get_symbol_name(arg_); !name.empty())
         *os_ << " (" << name << ")";
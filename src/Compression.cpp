@@ -0,0 +1,140 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "Compression.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <zlib.h>
+
+namespace abii
+{
+namespace
+{
+constexpr auto GZIP_WINDOW = 15 + 16; // The largest window, with a gzip header and trailer
+constexpr size_t READ_CHUNK = 1 << 16;
+
+int level = Z_BEST_SPEED;
+
+/*
+ * Copies an uncompressed log, leaving out the zeros a crashed memory-mapped log ends with
+ */
+void copy_plain(std::istream& is, std::ostream& os, std::string& buf, size_t available)
+{
+    // Zeros are only written once more text follows them
+    size_t zeros = 0;
+    while (available > 0)
+    {
+        for (size_t i = 0; i < available;)
+        {
+            auto text_end = i;
+            while (text_end < available && buf[text_end] != '\0')
+                ++text_end;
+            if (text_end > i)
+            {
+                os << std::string(zeros, '\0');
+                zeros = 0;
+                os.write(buf.data() + i, static_cast<std::streamsize>(text_end - i));
+            }
+            for (i = text_end; i < available && buf[i] == '\0'; ++i)
+                ++zeros;
+        }
+        is.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+        available = is.gcount();
+    }
+}
+}
+
+bool compression = false;
+size_t compression_block = 1 << 20;
+
+void configure_compression()
+{
+    if (const char* env_compress = getenv("ABII_COMPRESS"); env_compress != nullptr)
+    {
+        const auto value = strtol(env_compress, nullptr, 10);
+        if (value < 0 || value > 9)
+            std::cerr << "Unknown ABII_COMPRESS `" << env_compress << "`, using 1" << std::endl;
+        compression = value != 0;
+        if (value >= 1 && value <= 9)
+            level = static_cast<int>(value);
+    }
+    if (const char* env_block = getenv("ABII_COMPRESS_BLOCK"); env_block != nullptr)
+        if (const auto size = strtoull(env_block, nullptr, 0); size >= 4096)
+            compression_block = size;
+}
+
+std::string compress_block(const char* data, const size_t size)
+{
+    z_stream stream{};
+    if (deflateInit2(&stream, level, Z_DEFLATED, GZIP_WINDOW, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return {};
+
+    std::string out(deflateBound(&stream, size), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    stream.avail_in = size;
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = out.size();
+    // deflateBound() leaves enough room to finish in one call
+    const auto ret = deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return ret == Z_STREAM_END ? out : std::string();
+}
+
+bool decompress_log(std::istream& is, std::ostream& os)
+{
+    std::string in(READ_CHUNK, '\0');
+    std::string out(READ_CHUNK, '\0');
+
+    is.read(in.data(), 2);
+    auto available = static_cast<size_t>(is.gcount());
+    if (available < 2 || static_cast<unsigned char>(in[0]) != 0x1f || static_cast<unsigned char>(in[1]) != 0x8b)
+    {
+        copy_plain(is, os, in, available);
+        return true;
+    }
+
+    z_stream stream{};
+    if (inflateInit2(&stream, GZIP_WINDOW) != Z_OK)
+        return false;
+    stream.next_in = reinterpret_cast<Bytef*>(in.data());
+    stream.avail_in = available;
+    auto in_member = true;
+    auto ok = true;
+    while (true)
+    {
+        if (stream.avail_in == 0)
+        {
+            is.read(in.data(), static_cast<std::streamsize>(in.size()));
+            stream.next_in = reinterpret_cast<Bytef*>(in.data());
+            stream.avail_in = is.gcount();
+            if (stream.avail_in == 0)
+                break;
+        }
+        // Members never start with a zero byte, so this is the unused end of a memory-mapped log
+        if (!in_member && *stream.next_in == 0)
+            break;
+
+        stream.next_out = reinterpret_cast<Bytef*>(out.data());
+        stream.avail_out = out.size();
+        const auto ret = inflate(&stream, Z_NO_FLUSH);
+        os.write(out.data(), static_cast<std::streamsize>(out.size() - stream.avail_out));
+        in_member = true;
+        if (ret == Z_STREAM_END)
+        {
+            // The next block is a member of its own
+            inflateReset(&stream);
+            in_member = false;
+        }
+        else if (ret != Z_OK && ret != Z_BUF_ERROR)
+        {
+            ok = false;
+            break;
+        }
+    }
+    inflateEnd(&stream);
+    return ok && !in_member;
+}
+}
@@ -0,0 +1,50 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_COMPRESSION_H
+#define ABII_COMPRESSION_H
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace abii
+{
+/**
+ * Whether the text log is written as gzip blocks, set by ABII_COMPRESS
+ */
+extern bool compression;
+
+/**
+ * Uncompressed size of a block, set by ABII_COMPRESS_BLOCK (1 MiB by default)
+ */
+extern size_t compression_block;
+
+/**
+ * configure_compression() - Reads ABII_COMPRESS and ABII_COMPRESS_BLOCK
+ *
+ * ABII_COMPRESS is the zlib level, 1 (fastest) to 9, or 0 to leave the log uncompressed.
+ */
+void configure_compression();
+
+/**
+ * compress_block() - Compresses @p size bytes of @p data into one complete gzip member
+ *
+ * Members are independent and concatenated gzip members are a valid gzip file, so every block written is readable on
+ * its own and a crash loses at most the block that was still being filled.
+ */
+std::string compress_block(const char* data, size_t size);
+
+/**
+ * decompress_log() - Writes the text of a log of concatenated gzip members to @p os
+ *
+ * Uncompressed logs are copied as they are. The zeros a memory-mapped log ends with after a crash are left out.
+ *
+ * @return false if the log is corrupted or ends inside a member; everything before that point is still written
+ */
+bool decompress_log(std::istream& is, std::ostream& os);
+}
+
+#endif //ABII_COMPRESSION_H
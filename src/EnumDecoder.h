@@ -0,0 +1,319 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_ENUMDECODER_H
+#define ABII_ENUMDECODER_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace abii
+{
+/**
+ * One named value of an enum or flag set
+ *
+ * @struct EnumEntry EnumDecoder.h
+ */
+template<typename T>
+struct EnumEntry
+{
+    T value;
+    std::string_view name;
+};
+
+namespace enum_detail
+{
+template<typename T>
+struct bits_of
+{
+    using type = std::make_unsigned_t<T>;
+};
+
+template<typename T> requires std::is_enum_v<T>
+struct bits_of<T>
+{
+    using type = std::make_unsigned_t<std::underlying_type_t<T>>;
+};
+
+template<typename T>
+using bits_t = typename bits_of<T>::type;
+
+template<typename T>
+constexpr size_t BITS = sizeof(T) * 8;
+
+template<typename T>
+constexpr bits_t<T> to_bits(const T v)
+{
+    return static_cast<bits_t<T>>(v);
+}
+
+/*
+ * Views of the tables shared by EnumTable and EnumDecoder:
+ *  - sorted: entry indices ordered by value, then by index
+ *  - flags: indices of the entries with a positive value, grouped by their highest set bit and ordered by index
+ *  - buckets: where each bit's group starts in flags, plus the end of the last group
+ */
+template<typename T>
+struct Index
+{
+    std::span<const EnumEntry<T>> entries;
+    std::span<const uint32_t> sorted;
+    std::span<const uint32_t> flags;
+    std::span<const uint32_t> buckets;
+};
+
+template<typename T>
+constexpr void build(std::span<const EnumEntry<T>> entries, std::span<uint32_t> sorted, std::span<uint32_t> flags,
+                     std::span<uint32_t> buckets)
+{
+    for (uint32_t i = 0; i < entries.size(); ++i)
+        sorted[i] = i;
+    std::sort(sorted.begin(), sorted.end(), [&](const uint32_t a, const uint32_t b) {
+        return entries[a].value < entries[b].value || (entries[a].value == entries[b].value && a < b);
+    });
+
+    // buckets[b + 1] first counts the entries whose highest bit is b, then prefix sums turn counts into bounds
+    std::fill(buckets.begin(), buckets.end(), 0);
+    for (const auto& entry: entries)
+        if (entry.value > T{})
+            ++buckets[std::bit_width(to_bits(entry.value))];
+    for (size_t bit = 1; bit < buckets.size(); ++bit)
+        buckets[bit] += buckets[bit - 1];
+
+    auto next = std::array<uint32_t, BITS<T>>{};
+    std::copy(buckets.begin(), buckets.end() - 1, next.begin());
+    for (uint32_t i = 0; i < entries.size(); ++i)
+        if (entries[i].value > T{})
+            flags[next[std::bit_width(to_bits(entries[i].value)) - 1]++] = i;
+}
+
+/*
+ * Appends to a caller buffer and keeps counting once it is full, like snprintf()
+ */
+struct Writer
+{
+    char* buf;
+    size_t size;
+    size_t len = 0;
+
+    void put(const std::string_view str)
+    {
+        if (len < size)
+            memcpy(buf + len, str.data(), std::min(str.size(), size - len));
+        len += str.size();
+    }
+};
+
+template<typename T>
+std::span<const uint32_t> exact_matches(const Index<T>& index, const T v)
+{
+    const auto first = std::ranges::partition_point(index.sorted, [&](const uint32_t i) {
+        return index.entries[i].value < v;
+    });
+    const auto last = std::ranges::partition_point(first, index.sorted.end(), [&](const uint32_t i) {
+        return index.entries[i].value == v;
+    });
+    return {first, last};
+}
+
+template<typename T>
+size_t decode(const Index<T>& index, const T v, char* buf, const size_t size)
+{
+    Writer out{buf, size};
+    for (const auto i: exact_matches(index, v))
+    {
+        if (out.len != 0)
+            out.put(" & ");
+        out.put(index.entries[i].name);
+    }
+    return out.len;
+}
+
+template<typename T>
+size_t decode_flags(const Index<T>& index, const T v, char* buf, const size_t size)
+{
+    thread_local std::vector<uint32_t> matches;
+    matches.clear();
+    const auto exact = exact_matches(index, v);
+    matches.assign(exact.begin(), exact.end());
+
+    // Only entries whose highest bit is set in v can be contained in it
+    if (v > T{})
+        for (auto bits = to_bits(v); bits != 0; bits &= bits - 1)
+        {
+            const auto bit = std::countr_zero(bits);
+            for (auto j = index.buckets[bit]; j < index.buckets[bit + 1]; ++j)
+                if (const auto define = index.entries[index.flags[j]].value;
+                    define != v && v >= define && (to_bits(v) & to_bits(define)) == to_bits(define))
+                    matches.push_back(index.flags[j]);
+        }
+    std::ranges::sort(matches);
+
+    Writer out{buf, size};
+    for (const auto i: matches)
+    {
+        if (out.len != 0)
+            out.put(" | ");
+        out.put(index.entries[i].name);
+    }
+    return out.len;
+}
+}
+
+/**
+ * Decoder for a fixed set of values that can be built at compile time
+ *
+ * Exact matches are found by binary search. Flag decoding only visits the entries whose highest bit is set in the
+ * decoded value. Names are joined in the order the entries were given, like print_enum_entry() and
+ * print_or_enum_entries().
+ *
+ * @code
+ * constexpr abii::EnumTable open_flags(std::to_array<abii::EnumEntry<int>>({
+ *     {O_WRONLY, "O_WRONLY"}, {O_RDWR, "O_RDWR"}, {O_CREAT, "O_CREAT"}}));
+ * @endcode
+ *
+ * @tparam T Integral or enum type of the values
+ * @tparam N Number of entries
+ *
+ * @class EnumTable EnumDecoder.h
+ */
+template<typename T, size_t N>
+class EnumTable
+{
+public:
+    constexpr explicit EnumTable(const std::array<EnumEntry<T>, N>& entries) : entries_(entries)
+    {
+        enum_detail::build<T>(entries_, sorted_, flags_, buckets_);
+    }
+
+    /**
+     * decode() - Writes the names of the entries equal to @p v, joined with " & ", to @p buf
+     *
+     * @return Length of the full text; only the first @p size bytes are written and nothing is zero-terminated
+     */
+    size_t decode(const T v, char* buf, const size_t size) const { return enum_detail::decode(index(), v, buf, size); }
+
+    /**
+     * decode_flags() - Writes the names of the entries whose bits are all set in @p v, joined with " | ", to @p buf
+     *
+     * @return Length of the full text; only the first @p size bytes are written and nothing is zero-terminated
+     */
+    size_t decode_flags(const T v, char* buf, const size_t size) const
+    {
+        return enum_detail::decode_flags(index(), v, buf, size);
+    }
+
+    [[nodiscard]] std::string operator()(const T v) const { return to_string(v, false); }
+    [[nodiscard]] std::string flags(const T v) const { return to_string(v, true); }
+
+private:
+    [[nodiscard]] enum_detail::Index<T> index() const { return {entries_, sorted_, flags_, buckets_}; }
+
+    [[nodiscard]] std::string to_string(const T v, const bool flags) const
+    {
+        std::string str(64, '\0');
+        auto len = flags ? decode_flags(v, str.data(), str.size()) : decode(v, str.data(), str.size());
+        if (len > str.size())
+        {
+            str.resize(len);
+            len = flags ? decode_flags(v, str.data(), str.size()) : decode(v, str.data(), str.size());
+        }
+        str.resize(len);
+        return str;
+    }
+
+    std::array<EnumEntry<T>, N> entries_;
+    std::array<uint32_t, N> sorted_{};
+    std::array<uint32_t, N> flags_{};
+    std::array<uint32_t, enum_detail::BITS<T> + 1> buckets_{};
+};
+
+template<typename T, size_t N>
+EnumTable(const std::array<EnumEntry<T>, N>&) -> EnumTable<T, N>;
+
+/**
+ * Runtime counterpart of EnumTable, built once from one or more defines_map
+ *
+ * @code
+ * static const abii::EnumDecoder<int> errno_decoder(errno_defines);
+ * printer->set_enum_printer_<int>(std::cref(errno_decoder));
+ * @endcode
+ *
+ * @tparam T Integral or enum type of the decoded values
+ *
+ * @class EnumDecoder EnumDecoder.h
+ */
+template<typename T>
+class EnumDecoder
+{
+public:
+    template<typename... defines_maps>
+    explicit EnumDecoder(const defines_maps&... maps)
+    {
+        // Names are copied first so the entries can point into them
+        names_.reserve((maps.size() + ... + 0));
+        (std::ranges::for_each(maps, [&](const auto& define) { names_.push_back(define.second); }), ...);
+        entries_.reserve(names_.size());
+        auto name = names_.begin();
+        (std::ranges::for_each(maps, [&](const auto& define) { entries_.push_back({(T) define.first, *name++}); }),
+            ...);
+
+        sorted_.resize(entries_.size());
+        flags_.resize(entries_.size());
+        enum_detail::build<T>(entries_, sorted_, flags_, buckets_);
+    }
+
+    EnumDecoder(const EnumDecoder&) = delete;
+    EnumDecoder& operator=(const EnumDecoder&) = delete;
+
+    /**
+     * decode() - See EnumTable::decode()
+     */
+    size_t decode(const T v, char* buf, const size_t size) const { return enum_detail::decode(index(), v, buf, size); }
+
+    /**
+     * decode_flags() - See EnumTable::decode_flags()
+     */
+    size_t decode_flags(const T v, char* buf, const size_t size) const
+    {
+        return enum_detail::decode_flags(index(), v, buf, size);
+    }
+
+    [[nodiscard]] std::string operator()(const T v) const { return to_string(v, false); }
+    [[nodiscard]] std::string flags(const T v) const { return to_string(v, true); }
+
+private:
+    [[nodiscard]] enum_detail::Index<T> index() const { return {entries_, sorted_, flags_, buckets_}; }
+
+    [[nodiscard]] std::string to_string(const T v, const bool flags) const
+    {
+        std::string str(64, '\0');
+        auto len = flags ? decode_flags(v, str.data(), str.size()) : decode(v, str.data(), str.size());
+        if (len > str.size())
+        {
+            str.resize(len);
+            len = flags ? decode_flags(v, str.data(), str.size()) : decode(v, str.data(), str.size());
+        }
+        str.resize(len);
+        return str;
+    }
+
+    std::vector<std::string> names_;
+    std::vector<EnumEntry<T>> entries_;
+    std::vector<uint32_t> sorted_;
+    std::vector<uint32_t> flags_;
+    std::array<uint32_t, enum_detail::BITS<T> + 1> buckets_{};
+};
+}
+
+#endif //ABII_ENUMDECODER_H
@@ -0,0 +1,244 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "Filter.h"
+
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <fnmatch.h>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <semaphore.h>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+
+#include "FunctionRegistry.h"
+#include "libabii.h"
+
+namespace abii
+{
+namespace
+{
+struct FilterRules
+{
+    std::string path; // Empty unless the rules come from a file
+    std::vector<std::string> include;
+    std::vector<std::string> exclude;
+};
+
+struct FilterState
+{
+    std::mutex mutex;
+    FilterRules rules;
+    sem_t wakeup{};
+    int reload_signal = 0;
+    struct sigaction previous_action{};
+    std::atomic<bool> watching = false;
+    std::unique_ptr<std::thread> watcher;
+};
+
+// Used from abii_init() and until exit, so never destroyed
+FilterState& state()
+{
+    static auto state = new FilterState;
+    return *state;
+}
+
+void add_rules(const std::string& text, FilterRules& rules)
+{
+    size_t start = 0;
+    while (start <= text.size())
+    {
+        auto end = text.find_first_of(",\n", start);
+        if (end == std::string::npos)
+            end = text.size();
+        auto rule = text.substr(start, end - start);
+        start = end + 1;
+
+        rule.erase(0, rule.find_first_not_of(" \t\r"));
+        rule.erase(rule.find_last_not_of(" \t\r") + 1);
+        if (rule.empty())
+            continue;
+        if (rule[0] == '-')
+            rules.exclude.push_back(rule.substr(1));
+        else
+            rules.include.push_back(rule);
+    }
+}
+
+bool read_rules(const std::string& path, FilterRules& rules)
+{
+    std::ifstream file(path);
+    if (!file.is_open())
+        return false;
+    for (std::string line; std::getline(file, line);)
+        add_rules(line.substr(0, line.find('#')), rules);
+    return true;
+}
+
+bool matches(const std::vector<std::string>& patterns, const std::string& name)
+{
+    for (const auto& pattern: patterns)
+        if (fnmatch(pattern.c_str(), name.c_str(), 0) == 0)
+            return true;
+    return false;
+}
+
+timespec modified_time(const std::string& path)
+{
+    struct stat st{};
+    if (stat(path.c_str(), &st) != 0)
+        return {};
+    return st.st_mtim;
+}
+
+void on_reload_signal(const int sig, siginfo_t* info, void* context)
+{
+    sem_post(&state().wakeup);
+
+    // The signal is the program's as much as ours
+    const auto& previous = state().previous_action;
+    if (previous.sa_flags & SA_SIGINFO)
+        previous.sa_sigaction(sig, info, context);
+    else if (previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN)
+        previous.sa_handler(sig);
+}
+
+void watch(const std::string& path)
+{
+    // Reloading allocates and reads files, none of which may be logged
+    redirect = false;
+    auto& s = state();
+    auto last = modified_time(path);
+    while (s.watching.load(std::memory_order_acquire))
+    {
+        timespec deadline{};
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        ++deadline.tv_sec;
+        const auto signaled = sem_timedwait(&s.wakeup, &deadline) == 0;
+        if (!s.watching.load(std::memory_order_acquire))
+            break;
+
+        const auto modified = modified_time(path);
+        if (signaled || modified.tv_sec != last.tv_sec || modified.tv_nsec != last.tv_nsec)
+        {
+            last = modified;
+            reload_filter();
+        }
+    }
+}
+}
+
+bool configure_filter(const char* spec)
+{
+    FilterRules rules;
+    auto ok = true;
+    if (spec[0] == '@')
+    {
+        rules.path = spec + 1;
+        if (!read_rules(rules.path, rules))
+        {
+            std::cerr << "Could not read filter rules from " << rules.path << ", logging every function" << std::endl;
+            ok = false;
+        }
+    }
+    else
+        add_rules(spec, rules);
+
+    std::lock_guard lock(state().mutex);
+    state().rules = std::move(rules);
+    return ok;
+}
+
+int parse_signal(const char* spec)
+{
+    char* end = nullptr;
+    const auto number = strtol(spec, &end, 10);
+    if (end != spec && *end == '\0')
+        return number > 0 && number < NSIG ? static_cast<int>(number) : 0;
+
+    if (strncmp(spec, "SIG", 3) == 0)
+        spec += 3;
+    for (int sig = 1; sig < NSIG; ++sig)
+        if (const char* name = sigabbrev_np(sig); name != nullptr && strcmp(name, spec) == 0)
+            return sig;
+    return 0;
+}
+
+bool filter_allows(const std::string& name)
+{
+    std::lock_guard lock(state().mutex);
+    const auto& rules = state().rules;
+    return (rules.include.empty() || matches(rules.include, name)) && !matches(rules.exclude, name);
+}
+
+void reload_filter()
+{
+    {
+        auto& s = state();
+        std::lock_guard lock(s.mutex);
+        if (!s.rules.path.empty())
+        {
+            FilterRules rules{s.rules.path, {}, {}};
+            if (read_rules(rules.path, rules))
+                s.rules = std::move(rules);
+            else
+                std::cerr << "Could not read filter rules from " << rules.path << ", keeping the old ones" << std::endl;
+        }
+    }
+
+    // Functions registered from here on already see the new rules
+    for (uint32_t id = 0, count = function_count(); id < count; ++id)
+    {
+        auto& func = get_function(id);
+        func.enabled.store(filter_allows(func.name), std::memory_order_relaxed);
+    }
+}
+
+void start_filter_watcher(const int reload_signal)
+{
+    auto& s = state();
+    std::string path;
+    {
+        std::lock_guard lock(s.mutex);
+        path = s.rules.path;
+    }
+    if (path.empty() || s.watcher != nullptr)
+        return;
+
+    sem_init(&s.wakeup, 0, 0);
+    if (reload_signal != 0)
+    {
+        struct sigaction action{};
+        action.sa_sigaction = on_reload_signal;
+        action.sa_flags = SA_RESTART | SA_SIGINFO;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(reload_signal, &action, &s.previous_action) == 0)
+            s.reload_signal = reload_signal;
+    }
+
+    s.watching.store(true, std::memory_order_release);
+    s.watcher = std::make_unique<std::thread>(watch, std::move(path));
+}
+
+void stop_filter_watcher()
+{
+    auto& s = state();
+    if (s.watcher == nullptr)
+        return;
+    if (s.reload_signal != 0)
+    {
+        sigaction(s.reload_signal, &s.previous_action, nullptr);
+        s.reload_signal = 0;
+    }
+    s.watching.store(false, std::memory_order_release);
+    sem_post(&s.wakeup);
+    s.watcher->join();
+    s.watcher.reset();
+}
+}
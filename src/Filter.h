@@ -0,0 +1,63 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_FILTER_H
+#define ABII_FILTER_H
+
+#include <string>
+
+namespace abii
+{
+/**
+ * configure_filter() - Compiles the filter rules, usually the value of ABII_FILTER
+ *
+ * Rules are separated by commas or newlines and are fnmatch() globs over function names. A rule starting with '-'
+ * excludes the functions it matches. If any rule includes, only the included functions are logged, otherwise every
+ * function that is not excluded is.
+ *
+ * @code
+ * open*,read,-openat
+ * @endcode
+ *
+ * A spec of the form @c @<path> reads the rules from the file at @c <path>, where '#' starts a comment. Functions
+ * registered before the call keep their state until reload_filter().
+ *
+ * @return false if the rule file could not be read, in which case every function is logged
+ */
+bool configure_filter(const char* spec);
+
+/**
+ * filter_allows() - Whether the function @p name is logged under the current rules
+ */
+bool filter_allows(const std::string& name);
+
+/**
+ * reload_filter() - Re-reads the rule file, if any, and updates every registered function
+ */
+void reload_filter();
+
+/**
+ * parse_signal() - Parses a signal given by number or by name, with or without the SIG prefix, eg. 12, USR2 or SIGUSR2
+ *
+ * @return The signal number, or 0 if @p spec names no signal
+ */
+int parse_signal(const char* spec);
+
+/**
+ * start_filter_watcher() - Reloads the rule file whenever it changes, polling its modification time every second
+ *
+ * Does nothing unless the rules were read from a file.
+ *
+ * @param reload_signal If not 0, receiving this signal also reloads the rules. The program's own handler for it, if
+ *                      any, is still called after ours, and is put back by stop_filter_watcher().
+ */
+void start_filter_watcher(int reload_signal = 0);
+
+/**
+ * stop_filter_watcher() - Stops and joins the thread started by start_filter_watcher()
+ */
+void stop_filter_watcher();
+}
+
+#endif //ABII_FILTER_H
@@ -0,0 +1,69 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "FormatBuffer.h"
+
+#include <memory>
+#include <vector>
+
+namespace abii
+{
+namespace
+{
+// Storage kept by an idle stream; anything bigger came from an unusually large argument
+constexpr size_t MAX_IDLE_CAPACITY = 1 << 20;
+
+thread_local std::vector<std::unique_ptr<FormatStream>> idle_streams;
+}
+
+void FormatBuffer::shrink(const size_t max_capacity)
+{
+    if (data_.capacity() > max_capacity)
+    {
+        data_.clear();
+        data_.shrink_to_fit();
+    }
+}
+
+FormatBuffer::int_type FormatBuffer::overflow(const int_type ch)
+{
+    if (!traits_type::eq_int_type(ch, traits_type::eof()))
+        data_.push_back(traits_type::to_char_type(ch));
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize FormatBuffer::xsputn(const char* s, const std::streamsize count)
+{
+    data_.append(s, count);
+    return count;
+}
+
+void FormatStream::reset()
+{
+    buffer_.clear();
+    clear();
+    flags(skipws | dec);
+    precision(6);
+    width(0);
+    fill(' ');
+}
+
+ScratchStream::ScratchStream()
+{
+    if (idle_streams.empty())
+        stream_ = new FormatStream;
+    else
+    {
+        stream_ = idle_streams.back().release();
+        idle_streams.pop_back();
+    }
+    stream_->reset();
+}
+
+ScratchStream::~ScratchStream()
+{
+    stream_->buffer().shrink(MAX_IDLE_CAPACITY);
+    idle_streams.emplace_back(stream_);
+}
+} // abii
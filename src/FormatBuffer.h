@@ -0,0 +1,217 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_FORMATBUFFER_H
+#define ABII_FORMATBUFFER_H
+
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace abii
+{
+/*
+ * Writes @p value to [@p first, @p last) the way std::ostream does with the default flags, and returns the end of the
+ * text, or nullptr if it does not fit
+ */
+template<std::integral T>
+char* format_int(char* first, char* last, const T value, const int base = 10)
+{
+    const auto [end, ec] = std::to_chars(first, last, value, base);
+    return ec == std::errc() ? end : nullptr;
+}
+
+inline char* format_pointer(char* first, char* last, const void* ptr)
+{
+    if (ptr == nullptr)
+        return format_int(first, last, 0);
+    if (last - first < 2)
+        return nullptr;
+    first[0] = '0';
+    first[1] = 'x';
+    return format_int(first + 2, last, reinterpret_cast<uintptr_t>(ptr), 16);
+}
+
+template<std::floating_point T>
+char* format_float(char* first, char* last, const T value, const int precision)
+{
+    const auto [end, ec] = std::to_chars(first, last, value, std::chars_format::general, precision);
+    return ec == std::errc() ? end : nullptr;
+}
+
+/**
+ * Growable output buffer behind the streams printers write to while a call is formatted
+ *
+ * Numbers and pointers are appended with std::to_chars, without going through the locale. The storage is kept when
+ * the buffer is cleared, so a thread stops allocating once it has formatted its largest argument.
+ *
+ * @class FormatBuffer FormatBuffer.h
+ */
+class FormatBuffer final : public std::streambuf
+{
+public:
+    [[nodiscard]] std::string_view view() const { return data_; }
+    [[nodiscard]] std::string str() const { return data_; }
+    void clear() { data_.clear(); }
+
+    void append(const std::string_view str) { data_.append(str); }
+    void append(const char c) { data_.push_back(c); }
+
+    template<std::integral T>
+    void append_int(const T value, const int base = 10)
+    {
+        char digits[sizeof(T) * 8 + 1];
+        data_.append(digits, format_int(digits, digits + sizeof(digits), value, base));
+    }
+
+    void append_pointer(const void* ptr)
+    {
+        char digits[sizeof(uintptr_t) * 2 + 2];
+        data_.append(digits, format_pointer(digits, digits + sizeof(digits), ptr));
+    }
+
+    /**
+     * append_float() - Appends @p value like printf's %g with @p precision significant digits, at most 32
+     */
+    template<std::floating_point T>
+    void append_float(const T value, const int precision = 6)
+    {
+        char digits[64];
+        if (const auto end = format_float(digits, digits + sizeof(digits), value, precision); end != nullptr)
+            data_.append(digits, end);
+    }
+
+    /**
+     * shrink() - Gives back the storage of an unusually large argument
+     */
+    void shrink(size_t max_capacity);
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize count) override;
+
+private:
+    std::string data_;
+};
+
+/**
+ * std::ostream writing into a FormatBuffer
+ *
+ * @class FormatStream FormatBuffer.h
+ */
+class FormatStream final : public std::ostream
+{
+public:
+    FormatStream() : std::ostream(nullptr) { rdbuf(&buffer_); }
+
+    [[nodiscard]] FormatBuffer& buffer() { return buffer_; }
+    [[nodiscard]] std::string_view view() const { return buffer_.view(); }
+    [[nodiscard]] std::string str() const { return buffer_.str(); }
+
+    /**
+     * reset() - Empties the stream and restores the default formatting flags
+     */
+    void reset();
+
+private:
+    FormatBuffer buffer_;
+};
+
+/**
+ * Lease on one of the calling thread's FormatStreams, empty when taken and given back when destroyed
+ *
+ * Streams are only constructed when more of them are leased at once than ever before on the thread, which replaces
+ * the std::stringstream every argument used to build.
+ *
+ * @class ScratchStream FormatBuffer.h
+ */
+class ScratchStream
+{
+public:
+    ScratchStream();
+    ~ScratchStream();
+    ScratchStream(const ScratchStream&) = delete;
+    ScratchStream& operator=(const ScratchStream&) = delete;
+
+    FormatStream& operator*() const { return *stream_; }
+    FormatStream* operator->() const { return stream_; }
+    [[nodiscard]] FormatStream* get() const { return stream_; }
+
+private:
+    FormatStream* stream_;
+};
+
+/*
+ * Wrapper writing numbers and pointers with std::to_chars instead of the locale facets, as long as the stream uses the
+ * default formatting
+ */
+template<typename T>
+struct Formatted
+{
+    const T& value;
+};
+
+template<typename T>
+Formatted<T> formatted(const T& value) { return {value}; }
+
+template<typename T>
+constexpr bool is_char_like_v = std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+                                std::is_same_v<T, unsigned char> || std::is_same_v<T, wchar_t> ||
+                                std::is_same_v<T, char8_t> || std::is_same_v<T, char16_t> ||
+                                std::is_same_v<T, char32_t>;
+
+template<typename T>
+std::ostream& operator<<(std::ostream& os, const Formatted<T>& f)
+{
+    using V = std::remove_cv_t<T>;
+    using P = std::remove_cv_t<std::remove_pointer_t<V>>;
+    constexpr bool integer = std::is_integral_v<V> && !std::is_same_v<V, bool> && !is_char_like_v<V>;
+    constexpr bool floating = std::is_same_v<V, float> || std::is_same_v<V, double> || std::is_same_v<V, long double>;
+    // Strings, functions and volatile pointers are not printed as addresses by std::ostream
+    constexpr bool pointer = std::is_pointer_v<V> && (std::is_object_v<P> || std::is_void_v<P>) &&
+                             !is_char_like_v<P> && !std::is_volatile_v<std::remove_pointer_t<V>>;
+    if constexpr (integer || floating || pointer)
+        // Anything a printer changed on the stream is honoured by the standard formatting
+        if ((os.flags() & ~(std::ios::skipws | std::ios::dec)) == 0 && os.width() == 0 && os.precision() <= 32)
+        {
+            char text[64];
+            char* end;
+            if constexpr (integer)
+                end = format_int(text, text + sizeof(text), f.value);
+            else if constexpr (floating)
+                end = format_float(text, text + sizeof(text), f.value, static_cast<int>(os.precision()));
+            else
+                end = format_pointer(text, text + sizeof(text), reinterpret_cast<const void*>(f.value));
+            if (end != nullptr)
+                return os.write(text, end - text);
+        }
+    // std::ostream refuses wide characters; print the code unit like ArgPrinter<wchar_t> does
+    if constexpr (is_char_like_v<V> && !std::is_same_v<V, char> && !std::is_same_v<V, signed char> &&
+                  !std::is_same_v<V, unsigned char>)
+        return os << static_cast<uint32_t>(f.value);
+    else
+        return os << f.value;
+}
+
+/**
+ * element_name() - Returns the name of the element @p i of @p name, ie. name[i]
+ */
+template<std::integral T>
+std::string element_name(const std::string& name, const T i)
+{
+    char digits[sizeof(T) * 3 + 2];
+    const auto end = format_int(digits, digits + sizeof(digits), i);
+    std::string str;
+    str.reserve(name.size() + (end - digits) + 2);
+    str.append(name).append("[").append(digits, end).append("]");
+    return str;
+}
+} // abii
+
+#endif //ABII_FORMATBUFFER_H
@@ -0,0 +1,54 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "FunctionRegistry.h"
+
+#include <deque>
+#include <mutex>
+
+#include "Filter.h"
+
+namespace abii
+{
+namespace
+{
+std::mutex& registry_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+// std::deque keeps element addresses stable on push_back; never destroyed so abii_destructor() can still report
+std::deque<FunctionInfo>& registry()
+{
+    static auto functions = new std::deque<FunctionInfo>;
+    return *functions;
+}
+}
+
+FunctionInfo& register_function(const char* name)
+{
+    std::lock_guard lock(registry_mutex());
+    auto& functions = registry();
+    for (auto& func: functions)
+        if (func.name == name)
+            return func;
+    auto& func = functions.emplace_back(static_cast<uint32_t>(functions.size()), name);
+    func.enabled.store(filter_allows(func.name), std::memory_order_relaxed);
+    apply_sample_rule(func.name, func.sample);
+    return func;
+}
+
+uint32_t function_count()
+{
+    std::lock_guard lock(registry_mutex());
+    return static_cast<uint32_t>(registry().size());
+}
+
+FunctionInfo& get_function(const uint32_t id)
+{
+    std::lock_guard lock(registry_mutex());
+    return registry().at(id);
+}
+}
@@ -0,0 +1,53 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_FUNCTIONREGISTRY_H
+#define ABII_FUNCTIONREGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "Sampler.h"
+
+namespace abii
+{
+/**
+ * Per-process description of an intercepted function
+ *
+ * One instance exists for every overridden function name. Instances are never destroyed or moved, so references
+ * returned by register_function() stay valid for the lifetime of the process.
+ *
+ * @struct FunctionInfo FunctionRegistry.h
+ */
+struct FunctionInfo
+{
+    uint32_t id;
+    std::string name;
+    std::atomic<bool> enabled = true; // Cleared for functions filtered out by ABII_FILTER, see Filter.h
+    SampleState sample;
+};
+
+/**
+ * register_function() - Returns the FunctionInfo for @p name, creating it on first use
+ *
+ * New entries are filtered with filter_allows() and take their sampling rule from the last configure_sampling() call.
+ *
+ * @param name Name of the intercepted function, usually @code __func__ @endcode
+ * @return Reference to the function's registry entry
+ */
+FunctionInfo& register_function(const char* name);
+
+/**
+ * function_count() - Returns the number of functions registered so far
+ */
+uint32_t function_count();
+
+/**
+ * get_function() - Returns the registry entry with the given id
+ */
+FunctionInfo& get_function(uint32_t id);
+}
+
+#endif //ABII_FUNCTIONREGISTRY_H
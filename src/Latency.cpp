@@ -0,0 +1,156 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "Latency.h"
+
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "FunctionRegistry.h"
+
+namespace abii
+{
+bool timing = false;
+
+namespace
+{
+struct Calibration
+{
+    uint64_t ticks = 0;
+    uint64_t ns = 0;
+};
+
+/*
+ * Histograms are owned here rather than by their thread, so the ones of exited threads are still merged
+ */
+struct LatencyState
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<std::vector<std::unique_ptr<LatencyHistogram>>>> threads;
+    Calibration start;
+};
+
+// Used until abii_destructor(), so never destroyed
+LatencyState& state()
+{
+    static auto state = new LatencyState;
+    return *state;
+}
+
+uint64_t monotonic_ns()
+{
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+double ticks_per_ns()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    auto start = state().start;
+    if (start.ns == 0 || monotonic_ns() - start.ns < 1000000)
+    {
+        // Not enough time has passed since start_timing() for a precise ratio
+        start = {timestamp(), monotonic_ns()};
+        while (monotonic_ns() - start.ns < 10000000)
+            ;
+    }
+    const auto ns = monotonic_ns();
+    return static_cast<double>(timestamp() - start.ticks) / static_cast<double>(ns - start.ns);
+#else
+    return 1;
+#endif
+}
+
+double percentile(const std::array<uint64_t, LatencyHistogram::BUCKETS>& counts, const uint64_t total,
+                  const double fraction)
+{
+    const auto rank = static_cast<uint64_t>(fraction * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < LatencyHistogram::BUCKETS; ++i)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+            return static_cast<double>(LatencyHistogram::bucket_high(i));
+    }
+    return 0;
+}
+
+LatencySummary summarize(const uint32_t id, const double scale)
+{
+    std::array<uint64_t, LatencyHistogram::BUCKETS> counts{};
+    uint64_t max = 0;
+    {
+        auto& s = state();
+        std::lock_guard lock(s.mutex);
+        for (const auto& thread: s.threads)
+            if (id < thread->size() && (*thread)[id] != nullptr)
+                max = std::max(max, (*thread)[id]->merge_into(counts));
+    }
+
+    LatencySummary summary{0, 0, 0, 0, 0};
+    for (const auto count: counts)
+        summary.count += count;
+    if (summary.count == 0)
+        return summary;
+    // Bucket bounds can exceed the largest value actually seen
+    summary.p50 = std::min(percentile(counts, summary.count, 0.5), static_cast<double>(max)) / scale;
+    summary.p99 = std::min(percentile(counts, summary.count, 0.99), static_cast<double>(max)) / scale;
+    summary.p999 = std::min(percentile(counts, summary.count, 0.999), static_cast<double>(max)) / scale;
+    summary.max = static_cast<double>(max) / scale;
+    return summary;
+}
+}
+
+void start_timing()
+{
+    state().start = {timestamp(), monotonic_ns()};
+}
+
+void record_latency(const uint32_t id, const uint64_t ticks)
+{
+    thread_local std::vector<std::unique_ptr<LatencyHistogram>>* histograms = nullptr;
+    if (histograms == nullptr)
+    {
+        auto& s = state();
+        std::lock_guard lock(s.mutex);
+        histograms = s.threads.emplace_back(std::make_unique<std::vector<std::unique_ptr<LatencyHistogram>>>()).get();
+    }
+    if (id >= histograms->size() || (*histograms)[id] == nullptr)
+    {
+        // The vector may be read by a summary, which takes the same lock
+        std::lock_guard lock(state().mutex);
+        if (id >= histograms->size())
+            histograms->resize(id + 1);
+        (*histograms)[id] = std::make_unique<LatencyHistogram>();
+    }
+    (*histograms)[id]->record(ticks);
+}
+
+LatencySummary latency_summary(const uint32_t id)
+{
+    return summarize(id, ticks_per_ns());
+}
+
+void print_latency_table(std::ostream& os)
+{
+    const auto scale = ticks_per_ns();
+    os << "[ABII: call latency in ns]" << std::endl;
+    os << std::left << std::setw(32) << "function" << std::right << std::setw(12) << "count" << std::setw(12) << "p50"
+        << std::setw(12) << "p99" << std::setw(12) << "p999" << std::setw(12) << "max" << std::endl;
+    os << std::fixed << std::setprecision(0);
+    for (uint32_t id = 0; id < function_count(); ++id)
+    {
+        const auto summary = summarize(id, scale);
+        if (summary.count == 0)
+            continue;
+        os << std::left << std::setw(32) << get_function(id).name << std::right << std::setw(12) << summary.count
+            << std::setw(12) << summary.p50 << std::setw(12) << summary.p99 << std::setw(12) << summary.p999
+            << std::setw(12) << summary.max << std::endl;
+    }
+    os << std::defaultfloat;
+}
+}
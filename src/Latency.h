@@ -0,0 +1,132 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_LATENCY_H
+#define ABII_LATENCY_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <ctime>
+#include <ostream>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace abii
+{
+/**
+ * timing - Whether overrides time their real call, set from ABII_TIMING
+ */
+extern bool timing;
+
+/**
+ * timestamp() - Reads the TSC where there is one, CLOCK_MONOTONIC_RAW in nanoseconds otherwise
+ */
+inline uint64_t timestamp()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+/**
+ * Log-linear latency histogram in the style of HdrHistogram
+ *
+ * Values below 2 * SUB_BUCKETS have a bucket each. Above that, every power of two is split into SUB_BUCKETS buckets,
+ * so a bucket is at most 1 / SUB_BUCKETS of its value wide. Only the owning thread records, so the counters are
+ * atomics only to make reading them from another thread well defined.
+ *
+ * @class LatencyHistogram Latency.h
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr uint32_t SUB_BITS = 4;
+    static constexpr uint32_t SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr uint32_t BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    static constexpr uint32_t bucket_of(const uint64_t value)
+    {
+        const auto shift = std::max(0, static_cast<int>(std::bit_width(value)) - static_cast<int>(SUB_BITS) - 1);
+        return shift * SUB_BUCKETS + static_cast<uint32_t>(value >> shift);
+    }
+
+    /**
+     * bucket_high() - Returns the largest value that falls in @p bucket
+     */
+    static constexpr uint64_t bucket_high(const uint32_t bucket)
+    {
+        if (bucket < 2 * SUB_BUCKETS)
+            return bucket;
+        const auto shift = bucket / SUB_BUCKETS - 1;
+        return ((static_cast<uint64_t>(bucket % SUB_BUCKETS + SUB_BUCKETS) + 1) << shift) - 1;
+    }
+
+    void record(const uint64_t value)
+    {
+        auto& count = counts_[bucket_of(value)];
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (value > max_.load(std::memory_order_relaxed))
+            max_.store(value, std::memory_order_relaxed);
+    }
+
+    /**
+     * merge_into() - Adds the counts to @p counts and returns the largest recorded value
+     */
+    uint64_t merge_into(std::array<uint64_t, BUCKETS>& counts) const
+    {
+        for (uint32_t i = 0; i < BUCKETS; ++i)
+            counts[i] += counts_[i].load(std::memory_order_relaxed);
+        return max_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKETS> counts_{};
+    std::atomic<uint64_t> max_ = 0;
+};
+
+/**
+ * Latency of one function merged over every thread, in nanoseconds
+ *
+ * @struct LatencySummary Latency.h
+ */
+struct LatencySummary
+{
+    uint64_t count;
+    double p50;
+    double p99;
+    double p999;
+    double max;
+};
+
+/**
+ * start_timing() - Takes the first calibration point of the TSC against CLOCK_MONOTONIC_RAW
+ */
+void start_timing();
+
+/**
+ * record_latency() - Adds @p ticks, a difference of two timestamp() values, to the calling thread's histogram of the
+ * function @p id
+ */
+void record_latency(uint32_t id, uint64_t ticks);
+
+/**
+ * latency_summary() - Merges every thread's histogram of the function @p id
+ */
+LatencySummary latency_summary(uint32_t id);
+
+/**
+ * print_latency_table() - Writes the summary of every function that was timed to @p os
+ */
+void print_latency_table(std::ostream& os);
+}
+
+#endif //ABII_LATENCY_H
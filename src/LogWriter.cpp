@@ -0,0 +1,668 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "LogWriter.h"
+
+#include <algorithm>
+#include <bit>
+#include <condition_variable>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <mutex>
+#include <pthread.h>
+#include <sys/uio.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "Compression.h"
+#include "libabii.h"
+#include "MappedLog.h"
+
+namespace abii
+{
+namespace
+{
+constexpr auto WRITER_POLL = std::chrono::milliseconds(5);
+constexpr auto BLOCK_BACKOFF = std::chrono::microseconds(50);
+
+struct WriterState
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::shared_ptr<LogQueue>> queues;
+    std::unique_ptr<std::thread> thread;
+    bool stopping = false;
+};
+
+// Never destroyed: thread_local streams still reach it while the process exits
+WriterState& state()
+{
+    static const auto writer_state = new WriterState;
+    return *writer_state;
+}
+
+/*
+ * The log file shared by every thread
+ */
+struct ProcessLog
+{
+    std::mutex mutex;
+    std::string header; // Written first when the file is created
+    int fd = -1;
+    bool failed = false;
+    MappedLog* mapped = nullptr; // Set with ABII_WRITER=mmap
+};
+
+// Never destroyed, like WriterState
+ProcessLog& process_log()
+{
+    static const auto log = new ProcessLog;
+    return *log;
+}
+
+std::atomic_bool process_log_enabled = false;
+std::atomic_bool running = false;
+queue_policy policy = BLOCK;
+size_t queue_size = 1 << 20;
+bool mapped_mode = false;
+size_t mapped_chunk = 64 << 20;
+
+void write_all(const int fd, const char* data, size_t size)
+{
+    while (size > 0)
+    {
+        const ssize_t n = write(fd, data, size);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        data += n;
+        size -= n;
+    }
+}
+
+void writev_all(const int fd, iovec* iov, int iovcnt)
+{
+    while (iovcnt > 0)
+    {
+        ssize_t n = writev(fd, iov, iovcnt);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        while (iovcnt > 0 && static_cast<size_t>(n) >= iov->iov_len)
+        {
+            n -= static_cast<ssize_t>(iov->iov_len);
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + n;
+            iov->iov_len -= n;
+        }
+    }
+}
+
+/*
+ * Writes @p block as one gzip member and empties it
+ */
+void write_compressed(const int fd, std::string& block)
+{
+    if (block.empty())
+        return;
+    const auto member = compress_block(block.data(), block.size());
+    write_all(fd, member.data(), member.size());
+    block.clear();
+}
+
+void writer_main()
+{
+    // Threads start with overrides enabled, but the writer's own writes must never be logged
+    redirect = false;
+    auto& s = state();
+    std::vector<std::shared_ptr<LogQueue>> queues;
+    while (true)
+    {
+        bool stopping;
+        {
+            std::lock_guard lock(s.mutex);
+            stopping = s.stopping;
+            queues = s.queues;
+        }
+
+        size_t written = 0;
+        for (const auto& queue: queues)
+            written += queue->drain(stopping);
+
+        {
+            std::lock_guard lock(s.mutex);
+            std::erase_if(s.queues, [](const auto& queue) {
+                if (!queue->closed_.load(std::memory_order_acquire) || !queue->empty())
+                    return false;
+                queue->drain(true);
+                if (queue->owns_fd_)
+                    ::close(queue->fd_);
+                return true;
+            });
+        }
+
+        // The queues were drained after the stop request was seen, so everything pushed before it is written
+        if (stopping)
+            break;
+        if (written == 0)
+        {
+            std::unique_lock lock(s.mutex);
+            s.cv.wait_for(lock, WRITER_POLL, [&] { return s.stopping; });
+        }
+    }
+}
+
+/*
+ * The writer thread does not exist in a forked child, so the child writes synchronously. Records still queued
+ * belong to the parent, which writes them itself.
+ */
+void prepare_fork()
+{
+    state().mutex.lock();
+}
+
+void parent_fork()
+{
+    state().mutex.unlock();
+}
+
+void child_fork()
+{
+    auto& s = state();
+    if (running.exchange(false))
+    {
+        for (const auto& queue: s.queues)
+            queue->tail_.store(queue->head_.load());
+        s.queues.clear();
+        // The parent's thread handle is meaningless here and must never be joined
+        [[maybe_unused]] const auto orphan = s.thread.release();
+    }
+    s.mutex.unlock();
+}
+
+void notify_writer()
+{
+    state().cv.notify_one();
+}
+
+/*
+ * The forking thread is the only one left in the child, which logs to <comm>_<child pid>.txt instead
+ */
+void prepare_fork_process_log()
+{
+    process_log().mutex.lock();
+}
+
+void parent_fork_process_log()
+{
+    process_log().mutex.unlock();
+}
+
+void child_fork_process_log()
+{
+    auto& log = process_log();
+    // The parent's mappings are shared with it and must not be written here
+    if (log.mapped != nullptr)
+    {
+        log.mapped->forget();
+        delete log.mapped;
+        log.mapped = nullptr;
+    }
+    if (log.fd != -1)
+        ::close(log.fd);
+    log.header.clear();
+    log.fd = -1;
+    log.failed = false;
+    log.mutex.unlock();
+    abii_stream.detach();
+}
+
+int process_log_fd()
+{
+    auto& log = process_log();
+    std::lock_guard lock(log.mutex);
+    if (log.fd == -1 && !log.failed)
+    {
+        const auto path = get_process_logfname(compression ? ".txt.gz" : ".txt");
+        // Mapping needs read access, and pwrite() ignores the offset with O_APPEND
+        log.fd = mapped_mode ? ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0664)
+                     : ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0664);
+        // Reported once, every later record is dropped
+        if (log.fd == -1)
+        {
+            log.failed = true;
+            std::cerr << "Could not open " << path << std::endl;
+            return -1;
+        }
+
+        if (mapped_mode)
+            log.mapped = new MappedLog(log.fd, mapped_chunk);
+        const auto header = compression ? compress_block(log.header.data(), log.header.size()) : log.header;
+        if (log.mapped != nullptr)
+            log.mapped->append(header.data(), header.size());
+        else
+            write_all(log.fd, header.data(), header.size());
+    }
+    return log.fd;
+}
+
+/*
+ * Only called after process_log_fd() returned the file, which also set up the mapping
+ */
+void append_process_log(const char* data, const size_t size)
+{
+    auto& log = process_log();
+    if (log.mapped != nullptr)
+        log.mapped->append(data, size);
+    else
+        write_all(log.fd, data, size);
+}
+}
+
+LogQueue::LogQueue(const int fd, const size_t capacity, const bool owns_fd, const bool compress) :
+    capacity_(std::bit_ceil(capacity)), fd_(fd), owns_fd_(owns_fd), compress_(compress)
+{
+    data_ = std::make_unique<char[]>(capacity_);
+}
+
+bool LogQueue::push(const char* data, const size_t size)
+{
+    const auto head = head_.load(std::memory_order_relaxed);
+    const auto tail = tail_.load(std::memory_order_acquire);
+    if (capacity_ - (head - tail) < size)
+        return false;
+
+    const auto offset = head & (capacity_ - 1);
+    const auto first = std::min(size, capacity_ - offset);
+    memcpy(data_.get() + offset, data, first);
+    memcpy(data_.get(), data + first, size - first);
+    head_.store(head + size, std::memory_order_release);
+    return true;
+}
+
+size_t LogQueue::drain(const bool final)
+{
+    std::lock_guard lock(drain_mutex_);
+    const auto tail = tail_.load(std::memory_order_relaxed);
+    const auto head = head_.load(std::memory_order_acquire);
+    const auto size = head - tail;
+    const auto offset = tail & (capacity_ - 1);
+    const auto first = std::min(size, capacity_ - offset);
+    if (!compress_)
+    {
+        if (size == 0)
+            return 0;
+        iovec iov[2] = {{data_.get() + offset, first}, {data_.get(), size - first}};
+        writev_all(fd_, iov, size == first ? 1 : 2);
+        tail_.store(head, std::memory_order_release);
+        return size;
+    }
+
+    // Compressed on the draining thread, which is the writer thread while it runs
+    block_.append(data_.get() + offset, first);
+    block_.append(data_.get(), size - first);
+    tail_.store(head, std::memory_order_release);
+    if (final || block_.size() >= compression_block)
+        write_compressed(fd_, block_);
+    return size;
+}
+
+LogBuf::~LogBuf()
+{
+    // abii_stream is destroyed on thread exit while overrides are still enabled, and nothing can log after it
+    redirect = false;
+    end_record();
+    close();
+}
+
+bool LogBuf::open(const std::string& path)
+{
+    close();
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0664);
+    if (fd_ == -1)
+        return false;
+    if (running.load(std::memory_order_acquire))
+    {
+        queue_ = std::make_shared<LogQueue>(fd_, queue_size);
+        std::lock_guard lock(state().mutex);
+        state().queues.push_back(queue_);
+    }
+    return true;
+}
+
+void LogBuf::close()
+{
+    if (fd_ == -1)
+        return;
+    flush_pending();
+    if (queue_ != nullptr)
+    {
+        std::lock_guard lock(state().mutex);
+        if (running.load(std::memory_order_acquire))
+        {
+            // The writer thread closes the file once the queue is empty
+            queue_->closed_.store(true, std::memory_order_release);
+            queue_.reset();
+            fd_ = -1;
+            shared_ = false;
+            return;
+        }
+        queue_->drain(true);
+    }
+    write_block();
+    if (!shared_)
+        ::close(fd_);
+    queue_.reset();
+    fd_ = -1;
+    shared_ = false;
+}
+
+void LogBuf::end_record()
+{
+    if (fd_ == -1 && !pending_.empty() && process_log_enabled.load(std::memory_order_acquire))
+    {
+        fd_ = process_log_fd();
+        if (fd_ == -1)
+        {
+            pending_.clear();
+            return;
+        }
+        shared_ = true;
+        compress_ = compression;
+        if (running.load(std::memory_order_acquire))
+        {
+            queue_ = std::make_shared<LogQueue>(fd_, queue_size, false, compress_);
+            std::lock_guard lock(state().mutex);
+            state().queues.push_back(queue_);
+        }
+    }
+    flush_pending();
+}
+
+void LogBuf::detach()
+{
+    // The parent writes whatever it had pending itself
+    pending_.clear();
+    tag_.clear();
+    block_.clear();
+    queue_.reset();
+    if (!shared_)
+        return;
+    fd_ = -1;
+    shared_ = false;
+}
+
+void LogBuf::begin_record()
+{
+    if (!pending_.empty() || (fd_ != -1 && !shared_))
+        return;
+    if (tag_.empty())
+        tag_ = "[thread " + std::to_string(gettid()) + "]\n";
+    pending_ = tag_;
+}
+
+LogBuf::int_type LogBuf::overflow(const int_type ch)
+{
+    if (ch != traits_type::eof())
+    {
+        begin_record();
+        pending_ += traits_type::to_char_type(ch);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize LogBuf::xsputn(const char* s, const std::streamsize count)
+{
+    begin_record();
+    pending_.append(s, count);
+    return count;
+}
+
+int LogBuf::sync()
+{
+    // Records for the process log are only written whole, by end_record()
+    if (shared_ || (fd_ == -1 && process_log_enabled.load(std::memory_order_acquire)))
+        return 0;
+    return flush_pending();
+}
+
+int LogBuf::flush_pending()
+{
+    if (pending_.empty())
+        return 0;
+    if (fd_ == -1)
+    {
+        pending_.clear();
+        return 0;
+    }
+
+    if (queue_ != nullptr && running.load(std::memory_order_acquire))
+    {
+        push_async();
+        // The writer may have made its last pass while the record was pushed; stop_writer() clears running before it
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!running.load(std::memory_order_relaxed))
+            queue_->drain(true);
+    }
+    else
+    {
+        // Anything queued before the writer stopped goes first
+        if (queue_ != nullptr)
+            queue_->drain(true);
+        if (compress_)
+        {
+            block_ += pending_;
+            if (block_.size() >= compression_block)
+                write_block();
+        }
+        else
+            write_out(pending_.data(), pending_.size());
+    }
+    pending_.clear();
+    return 0;
+}
+
+void LogBuf::write_out(const char* data, const size_t size)
+{
+    if (shared_)
+        append_process_log(data, size);
+    else
+        write_all(fd_, data, size);
+}
+
+void LogBuf::write_block()
+{
+    if (block_.empty())
+        return;
+    const auto member = compress_block(block_.data(), block_.size());
+    write_out(member.data(), member.size());
+    block_.clear();
+}
+
+void LogBuf::push_async()
+{
+    if (queue_->dropped_ != 0)
+    {
+        const auto marker = "[ABII: " + std::to_string(queue_->dropped_) + " log records dropped]\n";
+        if (!queue_->push(marker.data(), marker.size()))
+        {
+            ++queue_->dropped_;
+            return;
+        }
+        queue_->dropped_ = 0;
+    }
+
+    // Pushed in pieces, a record larger than the whole queue could end up split around another thread's record in the
+    // process log, so it is written whole once everything queued before it is out
+    if (policy == BLOCK && pending_.size() > queue_->capacity_)
+    {
+        queue_->drain(true);
+        write_record();
+        return;
+    }
+    if (queue_->push(pending_.data(), pending_.size()))
+        return;
+    if (policy != BLOCK)
+    {
+        if (policy == COUNT)
+            ++queue_->dropped_;
+        notify_writer();
+        return;
+    }
+
+    while (!queue_->push(pending_.data(), pending_.size()))
+    {
+        if (!running.load(std::memory_order_acquire))
+        {
+            queue_->drain(true);
+            write_record();
+            return;
+        }
+        notify_writer();
+        std::this_thread::sleep_for(BLOCK_BACKOFF);
+    }
+}
+
+void LogBuf::write_record()
+{
+    if (compress_)
+    {
+        block_ += pending_;
+        write_block();
+    }
+    else
+        write_out(pending_.data(), pending_.size());
+}
+
+bool LogStream::open(const std::string& path)
+{
+    clear();
+    if (!buf_.open(path))
+    {
+        setstate(failbit);
+        return false;
+    }
+    return true;
+}
+
+void LogStream::close()
+{
+    buf_.close();
+}
+
+void open_process_log(const std::string& header)
+{
+    {
+        auto& log = process_log();
+        std::lock_guard lock(log.mutex);
+        log.header = header;
+    }
+    static std::once_flag atfork_once;
+    std::call_once(atfork_once, [] {
+        pthread_atfork(prepare_fork_process_log, parent_fork_process_log, child_fork_process_log);
+    });
+    process_log_enabled.store(true, std::memory_order_release);
+}
+
+void close_process_log()
+{
+    auto& log = process_log();
+    std::lock_guard lock(log.mutex);
+    if (log.mapped != nullptr)
+        log.mapped->trim();
+}
+
+void start_writer()
+{
+    const char* writer = getenv("ABII_WRITER");
+    if (writer == nullptr || strcmp(writer, "sync") == 0)
+        return;
+    if (strcmp(writer, "mmap") == 0)
+    {
+        if (const char* env_chunk = getenv("ABII_MMAP_CHUNK"); env_chunk != nullptr)
+            if (const auto size = strtoull(env_chunk, nullptr, 0); size >= 4096)
+                mapped_chunk = size;
+        mapped_mode = true;
+        return;
+    }
+    if (strcmp(writer, "async") != 0)
+    {
+        std::cerr << "Unknown ABII_WRITER `" << writer << "`, using sync" << std::endl;
+        return;
+    }
+
+    if (const char* env_policy = getenv("ABII_QUEUE_POLICY"); env_policy != nullptr)
+    {
+        if (strcmp(env_policy, "block") == 0)
+            policy = BLOCK;
+        else if (strcmp(env_policy, "drop") == 0)
+            policy = DROP;
+        else if (strcmp(env_policy, "count") == 0)
+            policy = COUNT;
+        else
+            std::cerr << "Unknown ABII_QUEUE_POLICY `" << env_policy << "`, using block" << std::endl;
+    }
+    if (const char* env_size = getenv("ABII_QUEUE_SIZE"); env_size != nullptr)
+        if (const auto size = strtoull(env_size, nullptr, 0); size >= 4096)
+            queue_size = size;
+
+    static std::once_flag atfork_once;
+    std::call_once(atfork_once, [] { pthread_atfork(prepare_fork, parent_fork, child_fork); });
+
+    auto& s = state();
+    std::lock_guard lock(s.mutex);
+    if (s.thread != nullptr)
+        return;
+    s.stopping = false;
+    running.store(true, std::memory_order_release);
+    s.thread = std::make_unique<std::thread>(writer_main);
+}
+
+void stop_writer()
+{
+    auto& s = state();
+    std::unique_ptr<std::thread> thread;
+    {
+        std::lock_guard lock(s.mutex);
+        if (s.thread == nullptr)
+            return;
+        s.stopping = true;
+        // Threads pushing from now on drain their own queue, since the writer may already be on its last pass
+        running.store(false, std::memory_order_release);
+        thread = std::move(s.thread);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    s.cv.notify_one();
+    thread->join();
+
+    std::lock_guard lock(s.mutex);
+    // Records pushed after the writer's last pass are written here, and streams closed since then hand their file to
+    // nobody else
+    for (const auto& queue: s.queues)
+    {
+        queue->drain(true);
+        if (queue->closed_.load(std::memory_order_acquire) && queue->owns_fd_)
+            ::close(queue->fd_);
+    }
+    s.queues.clear();
+    s.stopping = false;
+}
+
+bool writer_running()
+{
+    return running.load(std::memory_order_acquire);
+}
+}
@@ -0,0 +1,186 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_LOGWRITER_H
+#define ABII_LOGWRITER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace abii
+{
+/**
+ * What a thread does when its log queue has no room for a finished record
+ */
+enum queue_policy
+{
+    BLOCK, // Wait for the writer thread to make room
+    DROP, // Discard the record
+    COUNT // Discard the record and log how many were discarded once there is room again
+};
+
+/**
+ * Single-producer single-consumer byte ring between one intercepted thread and the writer thread
+ *
+ * The producer only advances head_ and the writer only advances tail_, so the producer never takes a lock. While the
+ * writer stops, the owning thread may drain its own queue too, so draining is serialized by drain_mutex_.
+ *
+ * @struct LogQueue LogWriter.h
+ */
+struct LogQueue
+{
+    LogQueue(int fd, size_t capacity, bool owns_fd = true, bool compress = false);
+    LogQueue(const LogQueue&) = delete;
+    LogQueue& operator=(const LogQueue&) = delete;
+
+    /**
+     * push() - Appends @p size bytes to the ring
+     *
+     * @return false if there is not enough room; nothing is written in that case
+     */
+    bool push(const char* data, size_t size);
+
+    /**
+     * drain() - Writes everything queued so far to fd with a single writev()
+     *
+     * A compressing queue collects the text into block_ instead, and only writes it once it holds a whole block or
+     * @p final is set.
+     *
+     * @return Number of bytes taken from the ring
+     */
+    size_t drain(bool final = false);
+
+    [[nodiscard]] bool empty() const { return head_.load(std::memory_order_acquire) == tail_.load(); }
+
+    std::unique_ptr<char[]> data_;
+    const size_t capacity_;
+    const int fd_;
+    const bool owns_fd_; // The process log is shared by every queue and never closed
+    const bool compress_;
+    std::string block_; // Only touched by whoever drains
+    std::mutex drain_mutex_;
+    alignas(64) std::atomic<size_t> head_ = 0;
+    alignas(64) std::atomic<size_t> tail_ = 0;
+    std::atomic_bool closed_ = false;
+    uint64_t dropped_ = 0;
+};
+
+/**
+ * Stream buffer behind abii_stream
+ *
+ * Text accumulates until the stream is flushed (every std::endl). In synchronous mode the pending text is then
+ * written to the log file directly; while the writer thread runs it is pushed into the thread's LogQueue instead.
+ *
+ * A buffer that was never opened writes to the process log once open_process_log() was called. It then only writes
+ * at end_record(), so each record reaches the file whole, behind a "[thread <tid>]" line. With ABII_COMPRESS the
+ * records are gathered into blocks, each written as one gzip member.
+ *
+ * @class LogBuf LogWriter.h
+ */
+class LogBuf final : public std::streambuf
+{
+public:
+    LogBuf() = default;
+    ~LogBuf() override;
+
+    bool open(const std::string& path);
+    [[nodiscard]] bool is_open() const { return fd_ != -1; }
+    void close();
+
+    /**
+     * end_record() - Writes everything since the previous record as one chunk
+     */
+    void end_record();
+
+    /**
+     * detach() - Forgets the process log and the pending text, for the thread that forked
+     */
+    void detach();
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize count) override;
+    int sync() override;
+
+private:
+    void begin_record();
+    int flush_pending();
+    void write_out(const char* data, size_t size);
+    void write_block();
+    void push_async();
+    void write_record();
+
+    int fd_ = -1;
+    bool shared_ = false; // fd_ is the process log
+    bool compress_ = false;
+    std::string block_; // Records not compressed yet, when not handed to the writer thread
+    std::string tag_;
+    std::string pending_;
+    std::shared_ptr<LogQueue> queue_;
+};
+
+/**
+ * Output stream writing to a log file through a LogBuf
+ *
+ * @class LogStream LogWriter.h
+ */
+class LogStream final : public std::ostream
+{
+public:
+    LogStream() : std::ostream(nullptr) { rdbuf(&buf_); }
+
+    bool open(const std::string& path);
+    [[nodiscard]] bool is_open() const { return buf_.is_open(); }
+    void close();
+    void end_record() { buf_.end_record(); }
+    void detach() { buf_.detach(); }
+
+private:
+    LogBuf buf_;
+};
+
+/**
+ * open_process_log() - Sends the records of every thread's abii_stream to ~/abii_log/<comm>_<pid>.txt
+ *
+ * The file is opened on the first record, with O_APPEND so records of different threads never overlap, and starts with
+ * @p header. A forked child logs to a file of its own. With compression, see Compression.h, the file is
+ * <comm>_<pid>.txt.gz instead.
+ */
+void open_process_log(const std::string& header);
+
+/**
+ * close_process_log() - Truncates a memory-mapped process log to the bytes written
+ *
+ * Later records are still appended, with pwrite().
+ */
+void close_process_log();
+
+/**
+ * start_writer() - Starts the background writer thread if ABII_WRITER=async
+ *
+ * ABII_QUEUE_POLICY (block, drop or count) selects what happens when a queue is full, and ABII_QUEUE_SIZE sets the
+ * size of each thread's queue in bytes. ABII_WRITER=mmap starts no thread but writes the process log through a
+ * MappedLog instead, mapped ABII_MMAP_CHUNK bytes (64 MiB by default) at a time.
+ */
+void start_writer();
+
+/**
+ * stop_writer() - Drains every queue and joins the writer thread
+ *
+ * Every record pushed before this call is written once it returns. Streams fall back to synchronous writes
+ * afterwards, so nothing logged later is lost either.
+ */
+void stop_writer();
+
+/**
+ * writer_running() - Whether records are currently handed to the writer thread
+ */
+bool writer_running();
+}
+
+#endif //ABII_LOGWRITER_H
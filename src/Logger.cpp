@@ -6,6 +6,8 @@
 
 #include <sys/stat.h>
 
+#include "libabii.h"
+
 thread_local std::ofstream Logger::ofstream_;
 
 __attribute__((constructor))
@@ -14,3 +16,12 @@ void LoggerInit()
     mkdir("abii_log", 0775);
     Logger::ofstream_ = std::ofstream(LOG_DIR "/###TRACE_LOG###.log", std::ios::app);
 }
+
+Logger::~Logger()
+{
+    // Runs after the override re-enabled redirection, so flushing must not reach an overridden write()
+    const auto redirect = abii::redirect;
+    abii::redirect = false;
+    ofstream_ << "Exiting " << scope_ << std::endl;
+    abii::redirect = redirect;
+}
@@ -17,7 +17,7 @@ class Logger
 public:
     Logger() = delete;
     explicit Logger(const char* scope) : scope_(scope) { ofstream_ << "Entering " << scope_ << std::endl; }
-    ~Logger() { ofstream_ << "Exiting " << scope_ << std::endl; }
+    ~Logger();
     friend void LoggerInit();
 };
 
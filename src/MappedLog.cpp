@@ -0,0 +1,142 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "MappedLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace abii
+{
+namespace
+{
+void pwrite_all(const int fd, const char* data, size_t size, off_t offset)
+{
+    while (size > 0)
+    {
+        const auto n = pwrite(fd, data, size, offset);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        data += n;
+        size -= n;
+        offset += n;
+    }
+}
+
+size_t round_to_pages(const size_t size)
+{
+    const auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return std::max(page, (size + page - 1) / page * page);
+}
+}
+
+MappedLog::MappedLog(const int fd, const size_t chunk_size) : fd_(fd), chunk_size_(round_to_pages(chunk_size)),
+                                                              chunks_(std::make_unique<std::atomic<char*>[]>(MAX_CHUNKS)),
+                                                              filled_(std::make_unique<std::atomic<uint64_t>[]>(MAX_CHUNKS)),
+                                                              end_(lseek(fd, 0, SEEK_END))
+{
+    // A reused file may end inside a chunk whose start is already written
+    if (const auto start = end_.load() % chunk_size_; start != 0)
+        filled_[end_.load() / chunk_size_] = start;
+}
+
+MappedLog::~MappedLog()
+{
+    trim();
+}
+
+char* MappedLog::chunk(const uint64_t index)
+{
+    if (const auto mapped = chunks_[index].load(std::memory_order_acquire); mapped != nullptr)
+        return mapped;
+
+    std::lock_guard lock(mutex_);
+    if (const auto mapped = chunks_[index].load(std::memory_order_relaxed); mapped != nullptr)
+        return mapped;
+    const auto offset = static_cast<off_t>(index * chunk_size_);
+    // Writing to a mapping past the end of the file raises SIGBUS, so the space must exist first
+    if (fallocate(fd_, 0, offset, static_cast<off_t>(chunk_size_)) != 0)
+    {
+        struct stat st{};
+        if (fstat(fd_, &st) != 0)
+            return nullptr;
+        if (st.st_size < offset + static_cast<off_t>(chunk_size_) &&
+            ftruncate(fd_, offset + static_cast<off_t>(chunk_size_)) != 0)
+            return nullptr;
+    }
+    const auto mapped = mmap(nullptr, chunk_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, offset);
+    if (mapped == MAP_FAILED)
+        return nullptr;
+    chunks_[index].store(static_cast<char*>(mapped), std::memory_order_release);
+    return static_cast<char*>(mapped);
+}
+
+void MappedLog::unmap(const uint64_t index)
+{
+    std::lock_guard lock(mutex_);
+    if (const auto mapped = chunks_[index].exchange(nullptr); mapped != nullptr)
+        munmap(mapped, chunk_size_);
+}
+
+void MappedLog::append(const char* data, size_t size)
+{
+    // Sequentially consistent with trim(), which sets trimmed_ before waiting for in_flight_
+    in_flight_.fetch_add(1);
+    auto offset = end_.fetch_add(size, std::memory_order_relaxed);
+    const auto trimmed = trimmed_.load();
+    if (trimmed)
+        in_flight_.fetch_sub(1, std::memory_order_release);
+
+    while (size > 0)
+    {
+        const auto index = offset / chunk_size_;
+        const auto within = offset % chunk_size_;
+        const auto n = std::min<uint64_t>(size, chunk_size_ - within);
+        const auto mapped = !trimmed && index < MAX_CHUNKS ? chunk(index) : nullptr;
+        if (mapped != nullptr)
+            memcpy(mapped + within, data, n);
+        else
+            pwrite_all(fd_, data, n, static_cast<off_t>(offset));
+        // Written bytes count whichever way they went, or a chunk others mapped would never be seen full. Only the
+        // last writer into a chunk sees it full, and nobody touches it afterwards.
+        if (index < MAX_CHUNKS && filled_[index].fetch_add(n, std::memory_order_acq_rel) + n == chunk_size_)
+            unmap(index);
+        data += n;
+        size -= n;
+        offset += n;
+    }
+    if (!trimmed)
+        in_flight_.fetch_sub(1, std::memory_order_release);
+}
+
+void MappedLog::trim()
+{
+    if (trimmed_.exchange(true))
+        return;
+    while (in_flight_.load(std::memory_order_acquire) != 0)
+        std::this_thread::yield();
+    for (uint64_t index = 0; index < MAX_CHUNKS; ++index)
+        if (chunks_[index].load(std::memory_order_relaxed) != nullptr)
+            unmap(index);
+    [[maybe_unused]] const auto ret = ftruncate(fd_, static_cast<off_t>(end_.load()));
+}
+
+void MappedLog::forget()
+{
+    for (uint64_t index = 0; index < MAX_CHUNKS; ++index)
+        if (const auto mapped = chunks_[index].exchange(nullptr); mapped != nullptr)
+            munmap(mapped, chunk_size_);
+    trimmed_ = true;
+}
+}
@@ -0,0 +1,71 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_MAPPEDLOG_H
+#define ABII_MAPPEDLOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace abii
+{
+/**
+ * Append-only file written through shared memory mappings
+ *
+ * The file is preallocated and mapped in chunks. A writer reserves its bytes with one fetch_add on the end offset and
+ * copies them straight into the mapping; a chunk is mapped by whoever first reaches it and unmapped once every byte of
+ * it is written. Pages of a shared mapping belong to the page cache, so whatever was copied survives a crash of the
+ * process. The file then ends with the zeroed, unused rest of its last chunk.
+ *
+ * @class MappedLog MappedLog.h
+ */
+class MappedLog
+{
+public:
+    /**
+     * @param fd File opened for reading and writing, without O_APPEND
+     * @param chunk_size Bytes mapped at a time, rounded up to whole pages
+     */
+    MappedLog(int fd, size_t chunk_size);
+    MappedLog(const MappedLog&) = delete;
+    MappedLog& operator=(const MappedLog&) = delete;
+    ~MappedLog();
+
+    /**
+     * append() - Copies @p size bytes to the end of the file
+     *
+     * Falls back to pwrite() for chunks that cannot be mapped and once the log is trimmed.
+     */
+    void append(const char* data, size_t size);
+
+    /**
+     * trim() - Waits for the appends in progress, unmaps every chunk and truncates the file to the bytes written
+     */
+    void trim();
+
+    /**
+     * forget() - Drops the mappings without touching the file, for a forked child that must not write to it
+     */
+    void forget();
+
+private:
+    char* chunk(uint64_t index);
+    void unmap(uint64_t index);
+
+    static constexpr uint64_t MAX_CHUNKS = 1 << 16;
+
+    const int fd_;
+    const size_t chunk_size_;
+    std::mutex mutex_; // Serializes mapping and unmapping
+    std::unique_ptr<std::atomic<char*>[]> chunks_;
+    std::unique_ptr<std::atomic<uint64_t>[]> filled_; // Bytes copied into each chunk
+    std::atomic<uint64_t> end_;
+    std::atomic<uint64_t> in_flight_ = 0;
+    std::atomic_bool trimmed_ = false;
+};
+}
+
+#endif //ABII_MAPPEDLOG_H
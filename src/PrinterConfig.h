@@ -0,0 +1,101 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_PRINTERCONFIG_H
+#define ABII_PRINTERCONFIG_H
+
+#include <cstdarg>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace abii
+{
+typedef std::function<std::string(const void*)> EnumPrinter;
+typedef std::function<std::string(const char*, va_list, size_t)> VaListPrinter;
+
+/**
+ * Printers set on an argument, by the depth of the object they apply to
+ *
+ * @struct PrinterConfig PrinterConfig.h
+ */
+struct PrinterConfig
+{
+    std::map<size_t, EnumPrinter> enum_printers;
+    std::map<size_t, VaListPrinter> va_list_printers;
+};
+
+/**
+ * Handle on the PrinterConfig of a printer
+ *
+ * The printer an override creates owns its configuration, which is only built if a printer is set. The printers of
+ * its elements and pointees borrow it, since they only live while it prints, so recursing copies nothing.
+ *
+ * @class PrinterConfigRef PrinterConfig.h
+ */
+class PrinterConfigRef
+{
+public:
+    PrinterConfigRef() = default;
+
+    // Borrows @p config from a parent printer
+    PrinterConfigRef(const PrinterConfig* config) : config_(config) {} // NOLINT(*-explicit-constructor)
+
+    [[nodiscard]] const PrinterConfig* get() const { return config_; }
+
+    /**
+     * enum_printer() - Returns the enum printer for objects at @p depth, or nullptr if there is none
+     */
+    [[nodiscard]] const EnumPrinter* enum_printer(const size_t depth) const
+    {
+        return config_ != nullptr ? find(config_->enum_printers, depth) : nullptr;
+    }
+
+    /**
+     * va_list_printer() - Returns the va_list printer for objects at @p depth, or nullptr if there is none
+     */
+    [[nodiscard]] const VaListPrinter* va_list_printer(const size_t depth) const
+    {
+        return config_ != nullptr ? find(config_->va_list_printers, depth) : nullptr;
+    }
+
+    /**
+     * has_va_list_printers() - Returns whether a va_list printer is set at any depth; what it prints does not depend on
+     * the bytes of the argument alone
+     */
+    [[nodiscard]] bool has_va_list_printers() const
+    {
+        return config_ != nullptr && !config_->va_list_printers.empty();
+    }
+
+    /**
+     * edit() - Returns the configuration to modify, copying it first unless this handle is its only owner
+     */
+    PrinterConfig& edit()
+    {
+        if (owned_ == nullptr || owned_.use_count() > 1)
+        {
+            owned_ = std::make_shared<PrinterConfig>(config_ != nullptr ? *config_ : PrinterConfig{});
+            config_ = owned_.get();
+        }
+        return *owned_;
+    }
+
+private:
+    template <typename F>
+    static const F* find(const std::map<size_t, F>& printers, const size_t depth)
+    {
+        if (printers.empty())
+            return nullptr;
+        const auto it = printers.find(depth);
+        return it != printers.end() ? &it->second : nullptr;
+    }
+
+    std::shared_ptr<PrinterConfig> owned_;
+    const PrinterConfig* config_ = nullptr;
+};
+} // abii
+
+#endif //ABII_PRINTERCONFIG_H
@@ -0,0 +1,267 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "PrintfFormat.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+namespace abii
+{
+namespace
+{
+constexpr size_t POINTER_CACHE_SIZE = 64;
+constexpr size_t CONTENT_CACHE_MAX = 1024;
+
+enum printf_length
+{
+    LEN_NONE,
+    LEN_HH,
+    LEN_H,
+    LEN_L,
+    LEN_LL,
+    LEN_BIG_L,
+    LEN_J,
+    LEN_Z,
+    LEN_T
+};
+
+struct StringHash
+{
+    using is_transparent = void;
+    size_t operator()(const std::string_view str) const { return std::hash<std::string_view>{}(str); }
+};
+
+struct FormatCache
+{
+    std::unordered_map<std::string, std::unique_ptr<PrintfFormat>, StringHash, std::equal_to<>> by_content;
+    std::array<std::pair<const char*, const PrintfFormat*>, POINTER_CACHE_SIZE> by_pointer{};
+};
+
+int parse_number(const char*& p)
+{
+    auto n = 0;
+    while (*p >= '0' && *p <= '9')
+        n = n * 10 + (*p++ - '0');
+    return n;
+}
+
+/*
+ * Argument index of the form "N$", or 0
+ */
+int parse_position(const char*& p)
+{
+    const auto q = p;
+    if (const auto position = parse_number(p); *p == '$' && position > 0)
+    {
+        ++p;
+        return position;
+    }
+    p = q;
+    return 0;
+}
+
+/*
+ * Skips a width or precision: a number, '*' (an int argument, possibly positional) or nothing
+ */
+void parse_amount(const char*& p, std::vector<PrintfConversion>& conversions)
+{
+    if (*p == '*')
+    {
+        ++p;
+        const auto position = parse_position(p);
+        conversions.push_back({PA_INT, '*', position});
+    }
+    else
+        parse_number(p);
+}
+
+printf_length parse_length(const char*& p)
+{
+    switch (*p)
+    {
+    case 'h':
+        return *++p == 'h' ? (++p, LEN_HH) : LEN_H;
+    case 'l':
+        return *++p == 'l' ? (++p, LEN_LL) : LEN_L;
+    case 'q':
+        ++p;
+        return LEN_LL;
+    case 'L':
+        ++p;
+        return LEN_BIG_L;
+    case 'j':
+        ++p;
+        return LEN_J;
+    case 'z':
+    case 'Z':
+        ++p;
+        return LEN_Z;
+    case 't':
+        ++p;
+        return LEN_T;
+    default:
+        return LEN_NONE;
+    }
+}
+
+/*
+ * Type pulled from the argument list for each length modifier and conversion; false if nothing is pulled
+ */
+bool arg_kind(const printf_length length, const char conversion, printf_arg& kind)
+{
+    switch (conversion)
+    {
+    case 'a':
+    case 'A':
+    case 'e':
+    case 'E':
+    case 'f':
+    case 'F':
+    case 'g':
+    case 'G':
+        kind = length == LEN_BIG_L ? PA_LONG_DOUBLE : PA_DOUBLE;
+        return true;
+    case 'c':
+    case 'C':
+        kind = PA_INT;
+        return true;
+    case 'd':
+    case 'i':
+        switch (length)
+        {
+        case LEN_L:
+        case LEN_Z:
+        case LEN_T:
+            kind = PA_LONG;
+            break;
+        case LEN_LL:
+        case LEN_BIG_L:
+        case LEN_J:
+            kind = PA_LONG_LONG;
+            break;
+        default:
+            kind = PA_INT;
+            break;
+        }
+        return true;
+    case 'o':
+    case 'u':
+    case 'x':
+    case 'X':
+        switch (length)
+        {
+        case LEN_NONE:
+            kind = PA_UNSIGNED;
+            break;
+        case LEN_HH:
+        case LEN_H:
+            kind = PA_INT;
+            break;
+        default:
+            kind = PA_UNSIGNED_LONG_LONG;
+            break;
+        }
+        return true;
+    case 's':
+        kind = length == LEN_L ? PA_WIDE_STRING : PA_STRING;
+        return true;
+    case 'S':
+        kind = length == LEN_H ? PA_STRING : PA_WIDE_STRING;
+        return true;
+    case 'p':
+        kind = PA_POINTER;
+        return true;
+    case 'n':
+        kind = PA_COUNT_POINTER;
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*
+ * Sorts the conversions of a positional format into argument order
+ */
+void order_positional(std::vector<PrintfConversion>& conversions)
+{
+    if (std::ranges::none_of(conversions, [](const auto& conversion) { return conversion.position != 0; }))
+        return;
+    if (std::ranges::any_of(conversions, [](const auto& conversion) { return conversion.position == 0; }))
+    {
+        conversions.clear();
+        return;
+    }
+
+    std::ranges::stable_sort(conversions, {}, &PrintfConversion::position);
+    const auto duplicates = std::ranges::unique(conversions, {}, &PrintfConversion::position);
+    conversions.erase(duplicates.begin(), duplicates.end());
+    for (size_t i = 0; i < conversions.size(); ++i)
+        if (conversions[i].position != static_cast<int>(i) + 1)
+        {
+            conversions.resize(i);
+            break;
+        }
+}
+}
+
+PrintfFormat compile_printf_format(const char* fmt)
+{
+    PrintfFormat format{fmt, {}};
+    for (auto p = fmt; *p != '\0'; ++p)
+    {
+        if (*p != '%')
+            continue;
+        if (*++p == '%')
+            continue;
+        if (*p == '\0')
+            break;
+
+        PrintfConversion conversion{PA_INT, '\0', parse_position(p)};
+        while (*p != '\0' && strchr("-+ #0'", *p) != nullptr)
+            ++p;
+        parse_amount(p, format.conversions);
+        if (*p == '.')
+            parse_amount(++p, format.conversions);
+        const auto length = parse_length(p);
+        if (*p == '\0')
+            break;
+        conversion.conversion = *p;
+        if (arg_kind(length, *p, conversion.kind))
+            format.conversions.push_back(conversion);
+    }
+    order_positional(format.conversions);
+    return format;
+}
+
+const PrintfFormat& printf_format(const char* fmt)
+{
+    thread_local FormatCache cache;
+
+    // Literals keep their address, but the same address may hold a different format later
+    auto& [pointer, compiled] = cache.by_pointer[(reinterpret_cast<uintptr_t>(fmt) >> 3) % POINTER_CACHE_SIZE];
+    if (pointer == fmt && strncmp(fmt, compiled->text.c_str(), compiled->text.size() + 1) == 0)
+        return *compiled;
+
+    const std::string_view text(fmt);
+    auto it = cache.by_content.find(text);
+    if (it == cache.by_content.end())
+    {
+        if (cache.by_content.size() >= CONTENT_CACHE_MAX)
+        {
+            cache.by_content.clear();
+            cache.by_pointer.fill({});
+        }
+        it = cache.by_content.emplace(text, std::make_unique<PrintfFormat>(compile_printf_format(fmt))).first;
+    }
+    pointer = fmt;
+    compiled = it->second.get();
+    return *compiled;
+}
+}
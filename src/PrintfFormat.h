@@ -0,0 +1,80 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_PRINTFFORMAT_H
+#define ABII_PRINTFFORMAT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace abii
+{
+/**
+ * Type a printf conversion takes from the argument list
+ */
+enum printf_arg : uint8_t
+{
+    PA_INT,
+    PA_UNSIGNED,
+    PA_LONG,
+    PA_LONG_LONG,
+    PA_UNSIGNED_LONG_LONG,
+    PA_DOUBLE,
+    PA_LONG_DOUBLE,
+    PA_POINTER,
+    PA_STRING,
+    PA_WIDE_STRING,
+    PA_COUNT_POINTER // %n: a pointer that is consumed but neither printed nor written through
+};
+
+/**
+ * One argument consumed by a printf format
+ *
+ * A width or precision given as '*' is its own PA_INT conversion, placed before the conversion it belongs to, with
+ * @c conversion set to '*'. Conversions that name their argument ("%2$d", "%*3$d") record it in @c position.
+ *
+ * @struct PrintfConversion PrintfFormat.h
+ */
+struct PrintfConversion
+{
+    printf_arg kind;
+    char conversion;
+    int position; // 1-based index of the argument, 0 if the conversion takes the next one
+};
+
+/**
+ * A printf format parsed once into the arguments it consumes, in argument order
+ *
+ * @struct PrintfFormat PrintfFormat.h
+ */
+struct PrintfFormat
+{
+    std::string text;
+    std::vector<PrintfConversion> conversions;
+};
+
+/**
+ * compile_printf_format() - Parses @p fmt
+ *
+ * Flags, widths, precisions, length modifiers and "%%" are skipped, except for the arguments of '*' widths and
+ * precisions. Positional formats ("%2$s %1$d") are sorted
+ * into argument order, keeping the first conversion of an argument referenced twice. Only the arguments before the
+ * first one the format never references are kept, as the type of the missing one is unknown, and a format mixing
+ * positional and sequential conversions keeps none.
+ */
+PrintfFormat compile_printf_format(const char* fmt);
+
+/**
+ * printf_format() - Returns the compiled form of @p fmt from the calling thread's cache
+ *
+ * Formats are looked up by address first, which is verified against the cached text, and then by content, so formats
+ * built at run time are compiled once as well.
+ *
+ * @return Reference valid until the calling thread's next call
+ */
+const PrintfFormat& printf_format(const char* fmt);
+}
+
+#endif //ABII_PRINTFFORMAT_H
@@ -0,0 +1,114 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "RealFunction.h"
+
+#include <algorithm>
+#include <dlfcn.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "AddressMap.h"
+
+namespace abii
+{
+thread_local constinit RealCall real_call;
+
+namespace
+{
+struct Slot
+{
+    void** slot;
+    const char* name;
+    void** target; // Real function called by the timing trampoline
+    void* timed;
+};
+
+// Filled by static initializers, so never destroyed
+std::vector<Slot>& slots()
+{
+    static auto slots = new std::vector<Slot>;
+    return *slots;
+}
+
+std::vector<std::string> libc_paths()
+{
+    std::ifstream maps("/proc/self/maps");
+    if (!maps.is_open())
+    {
+        std::cerr << "Failed to open /proc/self/maps\n";
+        return {};
+    }
+
+    std::vector<std::string> paths;
+    for (auto& entry: parse_maps(maps))
+        if (entry.path.find("libc.so") != std::string::npos && std::ranges::find(paths, entry.path) == paths.end())
+            paths.push_back(std::move(entry.path));
+    return paths;
+}
+}
+
+void* resolve_real_function(const char* name)
+{
+    if (const auto sym = dlsym(RTLD_NEXT, name); sym != nullptr)
+        return sym;
+    std::cerr << "Error in `dlsym`: " << dlerror() << std::endl;
+    for (const auto& path: libc_paths())
+    {
+        const auto handle = dlopen(path.c_str(), RTLD_NOW | RTLD_NOLOAD);
+        if (handle == nullptr)
+            continue;
+        const auto sym = dlsym(handle, name);
+        dlclose(handle);
+        if (sym != nullptr)
+            return sym;
+    }
+    return nullptr;
+}
+
+void resolve_real_functions()
+{
+    // Slots that cannot be resolved keep their stub
+    std::vector<Slot> missing;
+    for (const auto& slot: slots())
+    {
+        if (const auto sym = dlsym(RTLD_NEXT, slot.name); sym != nullptr)
+            *slot.slot = *slot.target = sym;
+        else
+            missing.push_back(slot);
+    }
+    if (missing.empty())
+        return;
+
+    for (const auto& path: libc_paths())
+    {
+        const auto handle = dlopen(path.c_str(), RTLD_NOW | RTLD_NOLOAD);
+        if (handle == nullptr)
+            continue;
+        std::erase_if(missing, [&](const Slot& slot) {
+            const auto sym = dlsym(handle, slot.name);
+            if (sym != nullptr)
+                *slot.slot = *slot.target = sym;
+            return sym != nullptr;
+        });
+        dlclose(handle);
+    }
+    for (const auto& slot: missing)
+        std::cerr << "Could not resolve `" << slot.name << "`" << std::endl;
+}
+
+void time_real_functions()
+{
+    for (const auto& slot: slots())
+        if (*slot.target != nullptr)
+            *slot.slot = slot.timed;
+}
+
+RealFunction::RealFunction(void** slot, const char* name, void** target, void* timed)
+{
+    slots().push_back({slot, name, target, timed});
+}
+}
@@ -0,0 +1,187 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_REALFUNCTION_H
+#define ABII_REALFUNCTION_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Latency.h"
+
+namespace abii
+{
+/**
+ * Bytes of stack arguments forwarded by the stub of a variadic function
+ */
+constexpr size_t REAL_STUB_STACK_ARGS = 512;
+
+/**
+ * resolve_real_function() - Looks up the next definition of @p name after the calling plugin, falling back to libc
+ *
+ * @return The symbol, or nullptr
+ */
+void* resolve_real_function(const char* name);
+
+/**
+ * resolve_real_functions() - Resolves every slot declared with REAL_FUNCTION in one pass
+ *
+ * Symbols dlsym(RTLD_NEXT) cannot find are looked up in the libc objects listed in /proc/self/maps, which is read
+ * once, with one handle per object.
+ */
+void resolve_real_functions();
+
+/**
+ * resolve_legacy_slot() - Resolves @p slot on its first use, for slots declared without REAL_FUNCTION
+ */
+template<typename F>
+void resolve_legacy_slot(F& slot, const char* name)
+{
+    if (slot == nullptr)
+        slot = reinterpret_cast<F>(resolve_real_function(name));
+}
+
+/**
+ * time_real_functions() - Points every resolved slot at its timing trampoline, see RealStub
+ */
+void time_real_functions();
+
+/**
+ * Static registration of a real-function slot, see REAL_FUNCTION
+ *
+ * @class RealFunction RealFunction.h
+ */
+class RealFunction
+{
+public:
+    RealFunction(void** slot, const char* name, void** target, void* timed);
+};
+
+/**
+ * The real call a logged call times
+ *
+ * The OVERRIDE macros arm it with their slot, and the slot's timing trampoline stamps the start of the first call
+ * through it, so the time spent formatting arguments pushed after the real call is never counted.
+ *
+ * @struct RealCall RealFunction.h
+ */
+struct RealCall
+{
+    const void* slot = nullptr;
+    uint64_t start = 0;
+};
+
+extern thread_local constinit RealCall real_call;
+
+/**
+ * arm_real_call() - Makes the next call through @p slot the one timed by the current logged call
+ */
+inline void arm_real_call(const void* slot)
+{
+    if (timing)
+        real_call = {slot, 0};
+}
+
+inline void begin_real_call(const void* slot)
+{
+    if (real_call.slot == slot)
+    {
+        real_call.slot = nullptr;
+        real_call.start = timestamp();
+    }
+}
+
+/*
+ * Function pointer type of a function without its attributes, which template arguments ignore with a warning. Only
+ * used in decltype().
+ */
+template<typename R, bool NE, typename... A>
+auto plain_function(R (*)(A...) noexcept(NE)) -> R (*)(A...) noexcept(NE);
+
+template<typename R, bool NE, typename... A>
+auto plain_function(R (*)(A..., ...) noexcept(NE)) -> R (*)(A..., ...) noexcept(NE);
+
+/**
+ * Initial value of a real-function slot, for calls made before resolve_real_functions()
+ *
+ * The stub resolves its own slot and forwards the call, so the slot never needs a null check. With ABII_TIMING the
+ * slot holds the timed() trampoline instead, which calls the real function from its target.
+ *
+ * @tparam F Pointer type of the real function
+ *
+ * @struct RealStub RealFunction.h
+ */
+template<typename F>
+struct RealStub;
+
+template<typename R, bool NE, typename... A>
+struct RealStub<R (*)(A...) noexcept(NE)>
+{
+    using type = R (*)(A...) noexcept(NE);
+
+    template<type* Slot, const char* Name>
+    static R call(A... args) noexcept(NE)
+    {
+        *Slot = reinterpret_cast<type>(resolve_real_function(Name));
+        return (*Slot)(args...);
+    }
+
+    template<type* Slot, type* Target>
+    static R timed(A... args) noexcept(NE)
+    {
+        begin_real_call(Slot);
+        return (*Target)(args...);
+    }
+};
+
+template<typename R, bool NE, typename... A>
+struct RealStub<R (*)(A..., ...) noexcept(NE)>
+{
+    using type = R (*)(A..., ...) noexcept(NE);
+
+    template<type* Slot, const char* Name>
+    static R call(A..., ...) noexcept(NE)
+    {
+        const auto apply_args = __builtin_apply_args();
+        *Slot = reinterpret_cast<type>(resolve_real_function(Name));
+        // Cast through void (*)(), the one function type other function pointers convert to without a warning
+        const auto real = reinterpret_cast<void (*)(...)>(reinterpret_cast<void (*)()>(*Slot));
+        __builtin_return(__builtin_apply(real, apply_args, REAL_STUB_STACK_ARGS));
+    }
+
+    template<type* Slot, type* Target>
+    static R timed(A..., ...) noexcept(NE)
+    {
+        const auto apply_args = __builtin_apply_args();
+        begin_real_call(Slot);
+        const auto real = reinterpret_cast<void (*)(...)>(reinterpret_cast<void (*)()>(*Target));
+        __builtin_return(__builtin_apply(real, apply_args, REAL_STUB_STACK_ARGS));
+    }
+};
+}
+
+/**
+ * REAL_FUNCTION() - Declares @p real_func, the slot holding the real @p func, and registers it for abii_init()
+ *
+ * Use at namespace scope, once per overridden function:
+ * @code
+ * REAL_FUNCTION(close, real_close)
+ * @endcode
+ * @p real_func is a reference to the slot, which lets the OVERRIDE macros tell it apart at compile time from slots
+ * declared the old way, as @code static decltype(&close) real_close = nullptr; @endcode, which they still resolve
+ * with dlsym() on their first call.
+ */
+#define REAL_FUNCTION(func, real_func) \
+    static constexpr char abii_real_name_##func[] = #func; \
+    static decltype(abii::plain_function(&func)) abii_real_slot_##func = \
+        abii::RealStub<decltype(abii::plain_function(&func))>::call<&abii_real_slot_##func, abii_real_name_##func>; \
+    static decltype(abii::plain_function(&func))& real_func = abii_real_slot_##func; \
+    static decltype(abii::plain_function(&func)) abii_real_target_##func = nullptr; \
+    [[maybe_unused]] static const abii::RealFunction abii_real_##func( \
+        reinterpret_cast<void**>(&abii_real_slot_##func), abii_real_name_##func, \
+        reinterpret_cast<void**>(&abii_real_target_##func), \
+        reinterpret_cast<void*>(abii::RealStub<decltype(abii::plain_function(&func))>::timed< \
+            &abii_real_slot_##func, &abii_real_target_##func>));
+
+#endif //ABII_REALFUNCTION_H
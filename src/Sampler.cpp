@@ -0,0 +1,156 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "Sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <unordered_map>
+
+namespace abii
+{
+bool sampling = false;
+
+namespace
+{
+struct SampleRule
+{
+    std::optional<uint64_t> every;
+    std::optional<double> rate;
+    std::optional<double> burst;
+};
+
+struct SampleConfig
+{
+    SampleRule defaults;
+    std::unordered_map<std::string, SampleRule> functions;
+};
+
+uint64_t thread_budget = 0;
+
+// Configured from abii_init(), which may run before this file's static initializers, and used until exit
+SampleConfig& sample_config()
+{
+    static auto config = new SampleConfig;
+    return *config;
+}
+
+uint64_t now_ns()
+{
+    // The coarse clock is read from the vDSO without a syscall and is fine grained enough for a rate limit
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+bool drop(SampleState& state)
+{
+    state.dropped.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool parse_item(const std::string& item)
+{
+    const auto eq = item.find('=');
+    if (eq == std::string::npos)
+        return false;
+    const auto colon = item.rfind(':', eq);
+    const auto key_start = colon == std::string::npos ? 0 : colon + 1;
+    const auto key = item.substr(key_start, eq - key_start);
+    const auto value = item.substr(eq + 1);
+    auto& config = sample_config();
+    auto& rule = colon == std::string::npos ? config.defaults : config.functions[item.substr(0, colon)];
+
+    char* end = nullptr;
+    if (key == "every")
+    {
+        const auto every = strtoull(value.c_str(), &end, 10);
+        if (every == 0)
+            return false;
+        rule.every = every;
+    }
+    else if (key == "rate" || key == "burst")
+    {
+        const auto amount = strtod(value.c_str(), &end);
+        if (!(amount > 0))
+            return false;
+        (key == "rate" ? rule.rate : rule.burst) = amount;
+    }
+    else if (key == "budget" && colon == std::string::npos)
+        thread_budget = strtoull(value.c_str(), &end, 10);
+    else
+        return false;
+    return !value.empty() && *end == '\0';
+}
+}
+
+bool configure_sampling(const char* spec)
+{
+    auto& config = sample_config();
+    config = {};
+    thread_budget = 0;
+    auto ok = true;
+    std::istringstream items(spec);
+    for (std::string item; std::getline(items, item, ',');)
+    {
+        if (item.empty())
+            continue;
+        if (!parse_item(item))
+        {
+            std::cerr << "Ignoring sampling item `" << item << "`" << std::endl;
+            ok = false;
+        }
+    }
+    sampling = config.defaults.every || config.defaults.rate || thread_budget != 0 || !config.functions.empty();
+    return ok;
+}
+
+void apply_sample_rule(const std::string& name, SampleState& state)
+{
+    const auto& config = sample_config();
+    auto rule = config.defaults;
+    if (const auto it = config.functions.find(name); it != config.functions.end())
+    {
+        rule.every = it->second.every ? it->second.every : rule.every;
+        rule.rate = it->second.rate ? it->second.rate : rule.rate;
+        rule.burst = it->second.burst ? it->second.burst : rule.burst;
+    }
+
+    state.every = rule.every.value_or(1);
+    if (rule.rate)
+    {
+        state.interval_ns = std::max<uint64_t>(1, std::llround(1e9 / *rule.rate));
+        const auto burst = std::max(1.0, rule.burst.value_or(*rule.rate));
+        state.burst_ns = static_cast<uint64_t>((std::floor(burst) - 1) * state.interval_ns);
+    }
+}
+
+bool sample(SampleState& state)
+{
+    thread_local uint64_t logged = 0;
+    if (thread_budget != 0 && logged >= thread_budget)
+        return drop(state);
+    if (state.every > 1 && state.calls.fetch_add(1, std::memory_order_relaxed) % state.every != 0)
+        return drop(state);
+    if (state.interval_ns != 0)
+    {
+        const auto now = now_ns();
+        auto next = state.next_ns.load(std::memory_order_relaxed);
+        do
+        {
+            if (next > now + state.burst_ns)
+                return drop(state);
+        }
+        while (!state.next_ns.compare_exchange_weak(next, std::max(next, now) + state.interval_ns,
+                                                    std::memory_order_relaxed));
+    }
+    ++logged;
+    return true;
+}
+}
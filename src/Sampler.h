@@ -0,0 +1,66 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_SAMPLER_H
+#define ABII_SAMPLER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace abii
+{
+/**
+ * Per-function sampling rule and counters
+ *
+ * The rule is fixed when the function is registered. The rate limit is kept as the earliest time the next call may be
+ * logged (GCRA), which is a token bucket held in a single atomic.
+ *
+ * @struct SampleState Sampler.h
+ */
+struct SampleState
+{
+    uint64_t every = 1; // Log one call in this many, 1 logs every call
+    uint64_t interval_ns = 0; // Time one token takes to refill, 0 disables the rate limit
+    uint64_t burst_ns = 0; // How far ahead of the refill the bucket may run
+    std::atomic<uint64_t> calls = 0;
+    std::atomic<uint64_t> next_ns = 0;
+    std::atomic<uint64_t> dropped = 0;
+};
+
+/**
+ * sampling - Whether any sampling rule is configured; false keeps every call on the logging path
+ */
+extern bool sampling;
+
+/**
+ * configure_sampling() - Parses a sampling spec, usually the value of ABII_SAMPLE
+ *
+ * The spec is a comma-separated list of @code [<function>:]<key>=<value> @endcode items. Keys are @c every (log one
+ * call in N), @c rate (calls logged per second), @c burst (calls logged back to back before @c rate applies, @c rate
+ * by default) and @c budget (calls logged per thread, global only). Items without a function apply to every function
+ * that has no item of its own for that key.
+ *
+ * @code
+ * every=10,malloc:rate=100,free:every=1000,budget=100000
+ * @endcode
+ *
+ * Only functions registered afterwards pick up the rules.
+ *
+ * @return false if part of the spec was not understood; the rest is still applied
+ */
+bool configure_sampling(const char* spec);
+
+/**
+ * apply_sample_rule() - Sets the rule for the function @p name on @p state
+ */
+void apply_sample_rule(const std::string& name, SampleState& state);
+
+/**
+ * sample() - Decides whether the current call is logged, counting it as dropped if not
+ */
+bool sample(SampleState& state);
+}
+
+#endif //ABII_SAMPLER_H
@@ -0,0 +1,110 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdio>
+#include <dirent.h>
+#include <type_traits>
+
+namespace abii
+{
+/** Largest snapshot taken of a single argument; bigger arguments are always re-rendered */
+constexpr size_t SNAPSHOT_MAX = 1 << 16;
+
+/**
+ * Types whose printed text depends only on their own bytes
+ */
+template <typename T>
+constexpr bool is_flat_v = std::is_arithmetic_v<std::remove_cv_t<T>> || std::is_enum_v<std::remove_cv_t<T>>
+    || std::is_null_pointer_v<std::remove_cv_t<T>>
+    || (std::is_pointer_v<std::remove_cv_t<T>> && std::is_function_v<std::remove_pointer_t<std::remove_cv_t<T>>>);
+
+/**
+ * Pointers that are printed without being dereferenced
+ */
+template <typename T>
+constexpr bool is_handle_v = std::is_pointer_v<std::remove_cv_t<T>>
+    && (std::is_void_v<std::remove_pointer_t<std::remove_cv_t<T>>>
+        || std::is_same_v<std::remove_cv_t<std::remove_pointer_t<std::remove_cv_t<T>>>, FILE>
+        || std::is_same_v<std::remove_cv_t<std::remove_pointer_t<std::remove_cv_t<T>>>, DIR>);
+
+inline void append_bytes(std::string& bytes, const void* data, const size_t size)
+{
+    bytes.append(static_cast<const char*>(data), size);
+}
+
+/**
+ * snapshot_arg() - Appends the bytes the printed text of @p arg depends on to @p bytes
+ *
+ * Pointers to flat types contribute the pointer, whether the pointee is readable and the pointee itself, so a pointee
+ * modified by the callee changes the snapshot.
+ *
+ * @tparam T Type of the argument
+ * @param arg Argument to snapshot
+ * @param bytes Snapshot to append to
+ * @param len Number of elements a pointer refers to, or 0 for one element (strings: up to their terminator)
+ * @return false if the printed text depends on more than a bounded number of bytes, in which case the argument has
+ * to be re-rendered after the call
+ */
+template <typename T>
+bool snapshot_arg(const T& arg, std::string& bytes, const size_t len = 0)
+{
+    using U = std::remove_cv_t<T>;
+    if constexpr (is_flat_v<U> || is_handle_v<U>)
+    {
+        append_bytes(bytes, std::addressof(arg), sizeof(U));
+        return true;
+    }
+    else if constexpr (std::is_same_v<U, std::string>)
+    {
+        if (arg.size() > SNAPSHOT_MAX)
+            return false;
+        bytes += arg;
+        return true;
+    }
+    else if constexpr (std::is_array_v<U>)
+    {
+        if constexpr (is_flat_v<std::remove_extent_t<U>> && sizeof(U) <= SNAPSHOT_MAX)
+        {
+            append_bytes(bytes, std::addressof(arg), sizeof(U));
+            return true;
+        }
+        else
+            return false;
+    }
+    else if constexpr (std::is_pointer_v<U> && is_flat_v<std::remove_pointer_t<U>>)
+    {
+        using E = std::remove_cv_t<std::remove_pointer_t<U>>;
+        const auto ptr = (const E*) arg;
+        append_bytes(bytes, &ptr, sizeof(ptr));
+        append_bytes(bytes, &len, sizeof(len));
+
+        ssize_t count = len != 0 ? static_cast<ssize_t>(len) : 1;
+        if constexpr (is_string_char_v<E>)
+            if (len == 0)
+            {
+                count = probe_terminated(ptr, sizeof(E), SNAPSHOT_MAX / sizeof(E));
+                if (count == SNAPSHOT_MAX / sizeof(E))
+                    return false;
+                // Include the terminator
+                if (count != -1)
+                    ++count;
+            }
+        if (count * sizeof(E) > SNAPSHOT_MAX)
+            return false;
+
+        const bool readable = count != -1 && bomb_detector(ptr, count);
+        bytes += readable ? '\1' : '\0';
+        if (readable)
+            append_bytes(bytes, ptr, count * sizeof(E));
+        return true;
+    }
+    else
+        return false;
+}
+}
+
+#endif //SNAPSHOT_H
@@ -0,0 +1,248 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef STATICARGSPRINTER_H
+#define STATICARGSPRINTER_H
+
+#include <array>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Wraps an argument into a factory for the printers of StaticArgsPrinter, named after the argument
+ */
+#define ABII_ARG(arg) [&] { return abii::ArgPrinter(arg, #arg); }
+
+/*
+ * Like OVERRIDE_PREFIX, with the signature and the arguments known at compile time. Printers can be configured
+ * through abii_args->get<I>() until abii_args->push_args() formats them, just before the real call.
+ */
+#define OVERRIDE_STATIC_PREFIX(real_func, signature, ...) \
+    static std::atomic<abii::FunctionInfo*> abii_func_slot{nullptr}; \
+    if (abii::redirect && abii::should_log(abii_func_slot, __func__)) \
+    { \
+        DISABLE_OVERRIDES \
+        TRACE_LOGGER \
+        auto& abii_func = *abii_func_slot.load(std::memory_order_relaxed); \
+        abii::prefix = ""; \
+        const auto abii_arena_marker = abii::arena().begin_scope(); \
+        const auto abii_args = new abii::StaticArgsPrinter(abii_func, signature, __VA_ARGS__); \
+        abii::arm_real_call(reinterpret_cast<const void*>(&(real_func)));
+
+#define OVERRIDE_STATIC_SUFFIX(real_func, ret) \
+        abii_args->print_args(ret); \
+        if (abii::mode == abii::TEXT_MODE) \
+        { \
+            abii::abii_stream << std::endl; \
+            abii::abii_stream.end_record(); \
+        } \
+        delete abii_args; \
+        abii::arena().end_scope(abii_arena_marker); \
+        ENABLE_OVERRIDES \
+        return ret; \
+    }
+
+namespace abii
+{
+/*
+ * One printer of StaticArgsPrinter, built in place from the prvalue its factory returns since printers cannot be
+ * copied or moved safely
+ */
+template <size_t I, typename P>
+struct PrinterSlot
+{
+    template <typename F>
+    explicit PrinterSlot(F&& make) : printer(std::forward<F>(make)()) {}
+
+    P printer;
+};
+
+template <typename Indices, typename... Printers>
+struct PrinterSlots;
+
+template <size_t... I, typename... Printers>
+struct PrinterSlots<std::index_sequence<I...>, Printers...> : PrinterSlot<I, Printers>...
+{
+    template <typename... F>
+    explicit PrinterSlots(F&&... make) : PrinterSlot<I, Printers>(std::forward<F>(make))... {}
+};
+
+/**
+ * ArgsPrinter for a fixed list of arguments
+ *
+ * The printers are held by value and called through their concrete types, so a wrapper formats its arguments
+ * without virtual calls or a vector of entries. The pre-call rendering and the diff printed after the call are the
+ * same as ArgsPrinter's.
+ *
+ * @tparam Printers Types of the argument printers, deduced from the factories given to the constructor
+ *
+ * @struct StaticArgsPrinter StaticArgsPrinter.tpp
+ */
+template <typename... Printers>
+struct StaticArgsPrinter
+{
+    static void* operator new(const size_t size) { return allocate_object(size); }
+    static void operator delete(void* ptr) { deallocate_object(ptr); }
+
+    /**
+     * StaticArgsPrinter() - Starts a call
+     *
+     * @param func Registry entry of the intercepted function
+     * @param signature Pre-formatted first line of the call, usually a literal since it is not copied
+     * @param make One callable per argument returning its printer, see ABII_ARG()
+     */
+    template <typename... F>
+    StaticArgsPrinter(const FunctionInfo& func, const std::string_view signature, F&&... make)
+        : binary_(mode == BINARY_MODE), stats_(mode == STATS_MODE), func_info_(&func), signature_(signature),
+          printers_(std::forward<F>(make)...)
+    {
+        if (binary_)
+            trace_buffer.begin_call(func.id);
+    }
+
+    StaticArgsPrinter(const StaticArgsPrinter&) = delete;
+    StaticArgsPrinter& operator=(const StaticArgsPrinter&) = delete;
+
+    template <size_t I>
+    auto& get()
+    {
+        return static_cast<PrinterSlot<I, std::tuple_element_t<I, std::tuple<Printers...>>>&>(printers_).printer;
+    }
+
+    [[nodiscard]] std::ostream* get_os() const { return os_; }
+
+    /**
+     * set_os() - Sets the stream of the call line and of the return value
+     */
+    void set_os(std::ostream* os) { os_ = os; }
+
+    /**
+     * push_args() - Formats the call line and the arguments as they are before the call
+     */
+    void push_args()
+    {
+        if (!binary_ && !stats_)
+        {
+            *os_ << prefix << signature_;
+            prefix += '\t';
+        }
+        for_each([&](auto& printer, std::string& before, std::optional<std::string>& snapshot) {
+            if (stats_)
+                bytes_ += printer.buffer_bytes();
+            else if (binary_)
+                printer.capture(false);
+            else
+            {
+                ScratchStream ss;
+                std::ostream* os = printer.get_os();
+                printer.set_os(ss.get());
+                if (!printer.snapshot(snapshot.emplace()))
+                    snapshot.reset();
+                VisitScope scope;
+                printer.print_arg();
+                printer.set_os(os);
+                before = ss->str();
+            }
+        });
+        if (timing)
+            call_start_ = timestamp();
+    }
+
+    /**
+     * print_args() - Ends a call without a return value
+     */
+    void print_args() { finish(static_cast<ArgPrinter<int>*>(nullptr), errno); }
+
+    /**
+     * print_args() - Ends a call returning @p ret, which is printed to the stream of the call line
+     */
+    template <typename R>
+    void print_args(R& ret)
+    {
+        const auto err = errno;
+        ArgPrinter ret_printer(ret, "return", os_);
+        finish(&ret_printer, err);
+    }
+
+private:
+    template <typename Fn>
+    void for_each(Fn&& fn)
+    {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (fn(get<I>(), before_[I], snapshots_[I]), ...);
+        }(std::index_sequence_for<Printers...>{});
+    }
+
+    template <typename R>
+    void finish(R* ret, const int err)
+    {
+        if (timing)
+            record_latency(func_info_->id, timestamp() - (real_call.start != 0 ? real_call.start : call_start_));
+        if (stats_)
+        {
+            record_call(func_info_->id, ret != nullptr && ret->is_error(), err, bytes_);
+            return;
+        }
+        if (binary_)
+        {
+            for_each([](auto& printer, std::string&, std::optional<std::string>&) { printer.capture_after(); });
+            if (ret != nullptr)
+                ret->capture(true);
+            trace_buffer.end_call();
+            return;
+        }
+
+        if (ret != nullptr)
+        {
+            VisitScope scope;
+            if (const auto ret_val = ret->get_value(); !ret_val.empty())
+                *os_ << " = " << ret_val;
+        }
+        *os_ << std::endl;
+        for_each([&](auto& printer, const std::string& before, const std::optional<std::string>& snapshot) {
+            // Arguments whose bytes did not change print the same text as before the call
+            if (snapshot.has_value())
+                if (std::string after; printer.snapshot(after) && after == *snapshot)
+                {
+                    *printer.get_os() << before;
+                    return;
+                }
+
+            ScratchStream ss;
+            std::ostream* os = printer.get_os();
+            printer.set_os(ss.get());
+            {
+                VisitScope scope;
+                printer.print_arg();
+            }
+            printer.set_os(os);
+            *os << print_diff(before, ss->str());
+        });
+        if (ret != nullptr)
+        {
+            VisitScope scope;
+            ret->print_arg();
+        }
+    }
+
+    bool binary_;
+    bool stats_;
+    uint64_t bytes_ = 0;
+    const FunctionInfo* func_info_;
+    uint64_t call_start_ = 0;
+    std::string_view signature_;
+    std::ostream* os_ = &abii_stream;
+    PrinterSlots<std::index_sequence_for<Printers...>, Printers...> printers_;
+    std::array<std::string, sizeof...(Printers)> before_;
+    std::array<std::optional<std::string>, sizeof...(Printers)> snapshots_;
+};
+
+template <typename... F>
+StaticArgsPrinter(const FunctionInfo&, std::string_view, F&&...) -> StaticArgsPrinter<std::invoke_result_t<F>...>;
+}
+
+#endif //STATICARGSPRINTER_H
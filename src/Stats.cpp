@@ -0,0 +1,242 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "Stats.h"
+
+#include <atomic>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <pthread.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "FunctionRegistry.h"
+
+namespace abii
+{
+namespace
+{
+using ErrnoCounts = std::map<std::pair<uint32_t, int>, uint64_t>;
+
+/*
+ * One cache line per function, so the counters of different threads never share one
+ */
+struct alignas(64) Counters
+{
+    std::atomic<uint64_t> calls = 0;
+    std::atomic<uint64_t> errors = 0;
+    std::atomic<uint64_t> bytes = 0;
+};
+
+struct ThreadStats
+{
+    pid_t tid;
+    std::string name;
+    std::vector<std::unique_ptr<Counters>> functions; // Indexed by function id, grown under the state mutex
+    std::mutex errno_mutex;
+    ErrnoCounts errnos;
+};
+
+struct ThreadTotals
+{
+    pid_t tid;
+    std::string name;
+    std::vector<std::pair<uint32_t, CallTotals>> functions;
+};
+
+struct StatsState
+{
+    std::mutex mutex;
+    std::vector<ThreadStats*> live;
+    std::vector<CallTotals> exited;
+    ErrnoCounts exited_errnos;
+    std::vector<ThreadTotals> threads;
+};
+
+// Used until abii_destructor(), so never destroyed
+StatsState& state()
+{
+    static auto state = new StatsState;
+    return *state;
+}
+
+void bump(std::atomic<uint64_t>& counter, const uint64_t n)
+{
+    // Only the owning thread writes, so a plain load and store is enough
+    counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+CallTotals totals_of(const Counters& counters)
+{
+    return {counters.calls.load(std::memory_order_relaxed), counters.errors.load(std::memory_order_relaxed),
+            counters.bytes.load(std::memory_order_relaxed)};
+}
+
+void add(CallTotals& to, const CallTotals& from)
+{
+    to.calls += from.calls;
+    to.errors += from.errors;
+    to.bytes += from.bytes;
+}
+
+ThreadTotals thread_totals(const ThreadStats& stats)
+{
+    ThreadTotals totals{stats.tid, stats.name, {}};
+    for (uint32_t id = 0; id < stats.functions.size(); ++id)
+        if (stats.functions[id] != nullptr)
+            totals.functions.emplace_back(id, totals_of(*stats.functions[id]));
+    return totals;
+}
+
+/*
+ * Folds a thread's counters into the process totals when it exits
+ */
+struct ThreadHandle
+{
+    ThreadStats* stats = nullptr;
+
+    ~ThreadHandle();
+};
+
+thread_local ThreadHandle handle;
+thread_local bool exited = false;
+
+ThreadHandle::~ThreadHandle()
+{
+    exited = true;
+    if (stats == nullptr)
+        return;
+
+    auto& s = state();
+    std::lock_guard lock(s.mutex);
+    auto totals = thread_totals(*stats);
+    for (const auto& [id, function]: totals.functions)
+    {
+        if (id >= s.exited.size())
+            s.exited.resize(id + 1, {0, 0, 0});
+        add(s.exited[id], function);
+    }
+    for (const auto& [key, count]: stats->errnos)
+        s.exited_errnos[key] += count;
+    s.threads.push_back(std::move(totals));
+    std::erase(s.live, stats);
+    delete stats;
+    stats = nullptr;
+}
+
+ThreadStats& thread_stats()
+{
+    if (handle.stats == nullptr)
+    {
+        char name[16] = "";
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        const auto stats = new ThreadStats{gettid(), name, {}, {}, {}};
+        auto& s = state();
+        std::lock_guard lock(s.mutex);
+        s.live.push_back(stats);
+        handle.stats = stats;
+    }
+    return *handle.stats;
+}
+
+/*
+ * Everything counted so far, from exited and running threads
+ */
+void collect(std::vector<CallTotals>& totals, ErrnoCounts& errnos, std::vector<ThreadTotals>& threads)
+{
+    auto& s = state();
+    std::lock_guard lock(s.mutex);
+    totals = s.exited;
+    errnos = s.exited_errnos;
+    threads = s.threads;
+    for (const auto stats: s.live)
+    {
+        auto thread = thread_totals(*stats);
+        for (const auto& [id, function]: thread.functions)
+        {
+            if (id >= totals.size())
+                totals.resize(id + 1, {0, 0, 0});
+            add(totals[id], function);
+        }
+        {
+            std::lock_guard errno_lock(stats->errno_mutex);
+            for (const auto& [key, count]: stats->errnos)
+                errnos[key] += count;
+        }
+        threads.push_back(std::move(thread));
+    }
+}
+}
+
+void record_call(const uint32_t id, const bool error, const int err, const uint64_t bytes)
+{
+    if (exited)
+        return;
+    auto& stats = thread_stats();
+    if (id >= stats.functions.size() || stats.functions[id] == nullptr)
+    {
+        std::lock_guard lock(state().mutex);
+        if (id >= stats.functions.size())
+            stats.functions.resize(id + 1);
+        stats.functions[id] = std::make_unique<Counters>();
+    }
+
+    auto& counters = *stats.functions[id];
+    bump(counters.calls, 1);
+    if (bytes != 0)
+        bump(counters.bytes, bytes);
+    if (error)
+    {
+        bump(counters.errors, 1);
+        std::lock_guard lock(stats.errno_mutex);
+        ++stats.errnos[{id, err}];
+    }
+}
+
+CallTotals call_totals(const uint32_t id)
+{
+    std::vector<CallTotals> totals;
+    ErrnoCounts errnos;
+    std::vector<ThreadTotals> threads;
+    collect(totals, errnos, threads);
+    return id < totals.size() ? totals[id] : CallTotals{0, 0, 0};
+}
+
+void write_stats(std::ostream& os)
+{
+    std::vector<CallTotals> totals;
+    ErrnoCounts errnos;
+    std::vector<ThreadTotals> threads;
+    collect(totals, errnos, threads);
+
+    os << std::left << std::setw(32) << "function" << std::right << std::setw(14) << "calls" << std::setw(14)
+        << "errors" << std::setw(18) << "bytes" << std::endl;
+    for (uint32_t id = 0; id < totals.size(); ++id)
+    {
+        if (totals[id].calls == 0)
+            continue;
+        os << std::left << std::setw(32) << get_function(id).name << std::right << std::setw(14) << totals[id].calls
+            << std::setw(14) << totals[id].errors << std::setw(18) << totals[id].bytes << std::endl;
+        for (auto it = errnos.lower_bound({id, INT32_MIN}); it != errnos.end() && it->first.first == id; ++it)
+        {
+            const auto err = it->first.second;
+            const auto name = strerrorname_np(err);
+            os << "    " << std::left << std::setw(28) << (name != nullptr ? name : "errno " + std::to_string(err))
+                << std::right << std::setw(28) << it->second << std::endl;
+        }
+    }
+
+    os << std::endl << std::left << std::setw(10) << "thread" << std::setw(18) << "name" << std::setw(32)
+        << "function" << std::right << std::setw(14) << "calls" << std::setw(14) << "errors" << std::endl;
+    for (const auto& thread: threads)
+        for (const auto& [id, function]: thread.functions)
+            os << std::left << std::setw(10) << thread.tid << std::setw(18) << thread.name << std::setw(32)
+                << get_function(id).name << std::right << std::setw(14) << function.calls << std::setw(14)
+                << function.errors << std::endl;
+}
+}
@@ -0,0 +1,75 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_STATS_H
+#define ABII_STATS_H
+
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+
+namespace abii
+{
+/**
+ * error_value() - Whether a returned value reports a failure
+ *
+ * Signed integers report failures as -1, pointers as NULL or MAP_FAILED. Nothing else is treated as an error.
+ */
+template <typename T>
+bool error_value(const T& value)
+{
+    using U = std::remove_cv_t<T>;
+    if constexpr (std::is_integral_v<U> && std::is_signed_v<U>)
+        return value == -1;
+    else if constexpr (std::is_pointer_v<U>)
+        return value == nullptr || reinterpret_cast<intptr_t>(value) == -1;
+    else
+        return false;
+}
+
+/**
+ * buffer_bytes() - Size in bytes of @p len elements pointed to by a T*, counting void as one byte
+ */
+template <typename T>
+size_t buffer_bytes(const size_t len)
+{
+    if constexpr (std::is_void_v<T> || std::is_function_v<T>)
+        return len;
+    else
+        return len * sizeof(T);
+}
+
+/**
+ * record_call() - Counts one call to the function @p id in the calling thread's counters
+ *
+ * @param error Whether the call failed, see error_value()
+ * @param err errno after the call, only looked at if @p error is set
+ * @param bytes Bytes in the buffers passed with a length
+ */
+void record_call(uint32_t id, bool error, int err, uint64_t bytes);
+
+/**
+ * Totals of one function over every thread
+ *
+ * @struct CallTotals Stats.h
+ */
+struct CallTotals
+{
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t bytes;
+};
+
+/**
+ * call_totals() - Merges the counters of exited threads and of the threads still running for the function @p id
+ */
+CallTotals call_totals(uint32_t id);
+
+/**
+ * write_stats() - Writes the per-function, per-errno and per-thread summary to @p os
+ */
+void write_stats(std::ostream& os);
+}
+
+#endif //ABII_STATS_H
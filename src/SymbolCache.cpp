@@ -0,0 +1,206 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "SymbolCache.h"
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+#include "libabii.h"
+
+namespace abii
+{
+namespace
+{
+constexpr size_t CACHE_SIZE = 256;
+
+/*
+ * glibc relocates the pointers in .dynamic in place, but not where .dynamic is read-only (the vDSO)
+ */
+template<typename T>
+const T* dynamic_ptr(const dl_phdr_info* info, const ElfW(Addr) ptr)
+{
+    return reinterpret_cast<const T*>(ptr < info->dlpi_addr ? info->dlpi_addr + ptr : ptr);
+}
+
+/*
+ * The dynamic section does not record how many symbols there are, but the hash tables cover all of them
+ */
+size_t gnu_hash_count(const uint32_t* hash)
+{
+    const auto nbuckets = hash[0];
+    const auto symoffset = hash[1];
+    const auto bloom_size = hash[2];
+    const auto buckets = reinterpret_cast<const uint32_t*>(reinterpret_cast<const ElfW(Addr)*>(hash + 4) + bloom_size);
+    const auto chain = buckets + nbuckets;
+
+    uint32_t last = 0;
+    for (uint32_t i = 0; i < nbuckets; ++i)
+        last = std::max(last, buckets[i]);
+    if (last < symoffset)
+        return symoffset;
+    while (!(chain[last - symoffset] & 1))
+        ++last;
+    return last + 1;
+}
+}
+
+std::string_view SymbolCache::lookup(const void* addr)
+{
+    struct Entry
+    {
+        uintptr_t addr = 0;
+        uint64_t generation = 0;
+        std::string name;
+    };
+    thread_local std::array<Entry, CACHE_SIZE> cache;
+
+    // Loads are noticed here since dlopen() is not interposed
+    if (const auto objects = link_map_generation(); objects != objects_generation_.load(std::memory_order_relaxed))
+        if (objects_generation_.exchange(objects, std::memory_order_relaxed) != objects)
+            invalidate();
+
+    const auto key = reinterpret_cast<uintptr_t>(addr);
+    const auto generation = generation_.load(std::memory_order_acquire);
+    auto& entry = cache[(key >> 4 ^ key >> 12) & (CACHE_SIZE - 1)];
+    if (entry.generation != generation || entry.addr != key)
+    {
+        entry.name = resolve(key);
+        entry.addr = key;
+        entry.generation = generation;
+    }
+    return entry.name;
+}
+
+void SymbolCache::invalidate()
+{
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+int SymbolCache::collect_object(dl_phdr_info* info, size_t, void* data)
+{
+    Object object{UINTPTR_MAX, 0, nullptr, nullptr, 0, info->dlpi_addr, false, {}};
+    const ElfW(Dyn)* dynamic = nullptr;
+    for (auto i = 0; i < info->dlpi_phnum; ++i)
+    {
+        const auto& phdr = info->dlpi_phdr[i];
+        if (phdr.p_type == PT_LOAD)
+        {
+            object.start = std::min<uintptr_t>(object.start, info->dlpi_addr + phdr.p_vaddr);
+            object.end = std::max<uintptr_t>(object.end, info->dlpi_addr + phdr.p_vaddr + phdr.p_memsz);
+        }
+        else if (phdr.p_type == PT_DYNAMIC)
+            dynamic = reinterpret_cast<const ElfW(Dyn)*>(info->dlpi_addr + phdr.p_vaddr);
+    }
+    if (dynamic == nullptr || object.start >= object.end)
+        return 0;
+
+    for (auto dyn = dynamic; dyn->d_tag != DT_NULL; ++dyn)
+        switch (dyn->d_tag)
+        {
+        case DT_SYMTAB:
+            object.symtab = dynamic_ptr<ElfW(Sym)>(info, dyn->d_un.d_ptr);
+            break;
+        case DT_STRTAB:
+            object.strtab = dynamic_ptr<char>(info, dyn->d_un.d_ptr);
+            break;
+        case DT_HASH:
+            object.nsyms = dynamic_ptr<ElfW(Word)>(info, dyn->d_un.d_ptr)[1];
+            break;
+        case DT_GNU_HASH:
+            if (object.nsyms == 0)
+                object.nsyms = gnu_hash_count(dynamic_ptr<uint32_t>(info, dyn->d_un.d_ptr));
+            break;
+        default:
+            break;
+        }
+    if (object.symtab == nullptr || object.strtab == nullptr)
+        object.nsyms = 0;
+
+    static_cast<std::vector<Object>*>(data)->push_back(std::move(object));
+    return 0;
+}
+
+std::string SymbolCache::resolve(const uintptr_t addr)
+{
+    {
+        std::shared_lock lock(mutex_);
+        if (built_ == generation_.load(std::memory_order_acquire))
+        {
+            const auto object = find_object(addr);
+            if (object == nullptr)
+                return "";
+            if (object->loaded)
+                return name_of(*object, addr);
+        }
+    }
+
+    std::unique_lock lock(mutex_);
+    if (const auto generation = generation_.load(std::memory_order_acquire); built_ != generation)
+        reload_locked(generation);
+    const auto object = find_object(addr);
+    if (object == nullptr)
+        return "";
+    if (!object->loaded)
+        load_symbols(*object);
+    return name_of(*object, addr);
+}
+
+void SymbolCache::reload_locked(const uint64_t generation)
+{
+    objects_.clear();
+    dl_iterate_phdr(collect_object, &objects_);
+    std::ranges::sort(objects_, {}, &Object::start);
+    built_ = generation;
+}
+
+SymbolCache::Object* SymbolCache::find_object(const uintptr_t addr)
+{
+    auto it = std::ranges::upper_bound(objects_, addr, {}, &Object::start);
+    if (it == objects_.begin())
+        return nullptr;
+    --it;
+    return addr < it->end ? &*it : nullptr;
+}
+
+void SymbolCache::load_symbols(Object& object)
+{
+    for (size_t i = 0; i < object.nsyms; ++i)
+    {
+        // Same filter as dladdr()
+        if (const auto& sym = object.symtab[i];
+            ELF64_ST_TYPE(sym.st_info) != STT_TLS && sym.st_shndx != SHN_UNDEF && sym.st_value != 0)
+            object.symbols.push_back({object.base + sym.st_value, sym.st_size, object.strtab + sym.st_name});
+    }
+    // Aliases keep their symbol table order, which decides the one dladdr() picks
+    std::ranges::stable_sort(object.symbols, {}, &Symbol::start);
+    object.loaded = true;
+}
+
+/*
+ * Like dladdr(), picks the symbol starting closest below @p addr and only accepts it if it contains @p addr. Of several
+ * aliases, the first one in the symbol table that contains @p addr wins.
+ */
+std::string SymbolCache::name_of(const Object& object, const uintptr_t addr)
+{
+    const auto end = std::ranges::upper_bound(object.symbols, addr, {}, &Symbol::start);
+    if (end == object.symbols.begin())
+        return "";
+    // Aliases share a start address but may differ in size
+    for (auto it = std::ranges::lower_bound(object.symbols.begin(), end, std::prev(end)->start, {}, &Symbol::start);
+         it != end; ++it)
+    {
+        if (it->size == 0 ? addr == it->start : addr < it->start + it->size)
+            return demangle(it->name);
+    }
+    return "";
+}
+
+SymbolCache& symbol_cache()
+{
+    static SymbolCache cache;
+    return cache;
+}
+}
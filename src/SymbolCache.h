@@ -0,0 +1,85 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_SYMBOLCACHE_H
+#define ABII_SYMBOLCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <link.h>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace abii
+{
+/**
+ * Address to symbol name resolution without dladdr()
+ *
+ * Each object in the link map gets a symbol table sorted by address, built from its dynamic symbol table the first
+ * time an address inside it is looked up. Resolved names are kept per thread in a small direct-mapped cache, so
+ * printing the same callback again costs one comparison. Results match dladdr(): the name of the dynamic symbol
+ * containing the address, or nothing.
+ *
+ * @class SymbolCache SymbolCache.h
+ */
+class SymbolCache
+{
+public:
+    /**
+     * lookup() - Returns the demangled name of the symbol containing @p addr
+     *
+     * @return View of the name, valid until the calling thread's next lookup, or an empty view if @p addr is not part
+     * of any dynamic symbol
+     */
+    std::string_view lookup(const void* addr);
+
+    /**
+     * invalidate() - Drops every table and cached name; called whenever objects are unloaded, loads are noticed by
+     * lookup()
+     */
+    void invalidate();
+
+private:
+    struct Symbol
+    {
+        uintptr_t start;
+        size_t size;
+        const char* name;
+    };
+
+    struct Object
+    {
+        uintptr_t start;
+        uintptr_t end;
+        const ElfW(Sym)* symtab;
+        const char* strtab;
+        size_t nsyms;
+        uintptr_t base;
+        bool loaded;
+        std::vector<Symbol> symbols;
+    };
+
+    static int collect_object(dl_phdr_info* info, size_t, void* data);
+    std::string resolve(uintptr_t addr);
+    void reload_locked(uint64_t generation);
+    [[nodiscard]] Object* find_object(uintptr_t addr);
+    static void load_symbols(Object& object);
+    static std::string name_of(const Object& object, uintptr_t addr);
+
+    std::vector<Object> objects_;
+    uint64_t built_ = 0;
+    std::atomic<uint64_t> generation_ = 1;
+    std::atomic<unsigned long long> objects_generation_ = 0;
+    std::shared_mutex mutex_;
+};
+
+/**
+ * symbol_cache() - Returns the process-wide SymbolCache
+ */
+SymbolCache& symbol_cache();
+}
+
+#endif //ABII_SYMBOLCACHE_H
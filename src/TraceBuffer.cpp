@@ -0,0 +1,192 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "TraceBuffer.h"
+
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "FunctionRegistry.h"
+#include "libabii.h"
+
+namespace abii
+{
+thread_local TraceBuffer trace_buffer;
+
+namespace
+{
+size_t buffer_capacity()
+{
+    static const size_t capacity = [] {
+        if (const char* env = getenv("ABII_TRACE_BUFFER"); env != nullptr)
+            if (const auto size = strtoull(env, nullptr, 0); size >= 4096)
+                return static_cast<size_t>(size);
+        return static_cast<size_t>(1 << 20);
+    }();
+    return capacity;
+}
+
+void write_all(const int fd, const char* data, size_t size)
+{
+    while (size > 0)
+    {
+        const ssize_t n = write(fd, data, size);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        data += n;
+        size -= n;
+    }
+}
+
+template <typename T>
+void put(std::string& str, const T& value)
+{
+    str.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+}
+
+TraceBuffer::~TraceBuffer()
+{
+    flush();
+    if (fd_ != -1)
+        close(fd_);
+}
+
+void TraceBuffer::begin_call(const uint32_t func_id)
+{
+    announce_function(func_id);
+
+    timespec ts{};
+    clock_gettime(CLOCK_REALTIME, &ts);
+    const uint64_t timestamp = static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+
+    record_.clear();
+    put(record_, timestamp);
+    put(record_, func_id);
+    put(record_, static_cast<uint16_t>(0));
+    nvalues_ = 0;
+}
+
+void TraceBuffer::push_value(const trace_kind kind, const uint8_t flags, const std::string_view type_name,
+                             const std::string_view name, const void* data, const size_t size)
+{
+    const auto type = type_index(type_name);
+    const auto name_size = static_cast<uint16_t>(std::min<size_t>(name.size(), UINT16_MAX));
+    put(record_, static_cast<uint8_t>(kind));
+    put(record_, flags);
+    put(record_, type);
+    put(record_, name_size);
+    put(record_, static_cast<uint32_t>(size));
+    record_.append(name.data(), name_size);
+    if (size != 0)
+        record_.append(static_cast<const char*>(data), size);
+    ++nvalues_;
+}
+
+void TraceBuffer::end_call()
+{
+    memcpy(record_.data() + sizeof(uint64_t) + sizeof(uint32_t), &nvalues_, sizeof(nvalues_));
+    append_record(TR_CALL, record_);
+}
+
+void TraceBuffer::flush()
+{
+    if (used_ == 0)
+        return;
+    const auto old_redirect = redirect;
+    DISABLE_OVERRIDES
+    open();
+    if (fd_ != -1)
+        write_all(fd_, buffer_.data(), used_);
+    used_ = 0;
+    redirect = old_redirect;
+}
+
+void TraceBuffer::announce_function(const uint32_t func_id)
+{
+    if (func_id < announced_.size() && announced_[func_id])
+        return;
+    if (func_id >= announced_.size())
+        announced_.resize(func_id + 1);
+    announced_[func_id] = true;
+
+    scratch_.clear();
+    put(scratch_, func_id);
+    scratch_ += get_function(func_id).name;
+    append_record(TR_FUNCTION, scratch_);
+}
+
+uint16_t TraceBuffer::type_index(const std::string_view type_name)
+{
+    // Every type's name is a distinct static string, so its address identifies the type
+    if (const auto it = types_.find(type_name.data()); it != types_.end())
+        return it->second;
+    const auto index = static_cast<uint16_t>(types_.size());
+    types_.emplace(type_name.data(), index);
+
+    scratch_.clear();
+    put(scratch_, index);
+    scratch_ += type_name;
+    append_record(TR_TYPE, scratch_);
+    return index;
+}
+
+void TraceBuffer::append_record(const trace_record_type type, const std::string& payload)
+{
+    if (buffer_.empty())
+        buffer_.resize(buffer_capacity());
+
+    const size_t size = sizeof(uint8_t) + sizeof(uint32_t) + payload.size();
+    if (used_ + size > buffer_.size())
+        flush();
+    if (size > buffer_.size())
+    {
+        // Oversized records bypass the buffer
+        std::string record;
+        put(record, type);
+        put(record, static_cast<uint32_t>(payload.size()));
+        record += payload;
+        const auto old_redirect = redirect;
+        DISABLE_OVERRIDES
+        open();
+        if (fd_ != -1)
+            write_all(fd_, record.data(), record.size());
+        redirect = old_redirect;
+        return;
+    }
+
+    const auto payload_size = static_cast<uint32_t>(payload.size());
+    buffer_[used_] = static_cast<char>(type);
+    memcpy(&buffer_[used_ + sizeof(uint8_t)], &payload_size, sizeof(payload_size));
+    memcpy(&buffer_[used_ + sizeof(uint8_t) + sizeof(uint32_t)], payload.data(), payload.size());
+    used_ += size;
+}
+
+void TraceBuffer::open()
+{
+    if (fd_ != -1)
+        return;
+    const auto path = get_logfname(".abt");
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0664);
+    if (fd_ == -1)
+        return;
+
+    if (lseek(fd_, 0, SEEK_END) == 0)
+    {
+        std::string header(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+        put(header, static_cast<uint8_t>(TRACE_VERSION));
+        put(header, static_cast<uint8_t>(sizeof(void*)));
+        put(header, static_cast<uint16_t>(0));
+        put(header, static_cast<uint32_t>(getpid()));
+        put(header, static_cast<uint32_t>(gettid()));
+        write_all(fd_, header.data(), header.size());
+    }
+}
+}
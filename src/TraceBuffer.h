@@ -0,0 +1,117 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_TRACEBUFFER_H
+#define ABII_TRACEBUFFER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Binary trace file layout (host byte order)
+ *
+ *   file header:  char magic[8] = "ABIITRC", u8 version, u8 pointer size, u16 reserved, u32 pid, u32 tid
+ *   record:       u8 record type, u32 payload size, payload
+ *
+ *   TR_FUNCTION payload: u32 function id, function name
+ *   TR_TYPE payload:     u16 type index, type name
+ *   TR_CALL payload:     u64 timestamp (ns since epoch), u32 function id, u16 value count, values...
+ *   value:               u8 kind, u8 flags, u16 type index, u16 name size, u32 data size, name, data
+ *
+ * TK_STRING and TK_POINTER data is the pointer followed by at most TRACE_STRING_MAX or TRACE_POINTEE_MAX bytes of what
+ * it points to. Pointers the callee may write through are recorded again after the call, as a value flagged TF_AFTER.
+ */
+#define TRACE_MAGIC "ABIITRC"
+#define TRACE_VERSION 2
+#define TRACE_STRING_MAX 256
+#define TRACE_OPAQUE_MAX 256
+#define TRACE_POINTEE_MAX 256
+
+namespace abii
+{
+enum trace_record_type : uint8_t
+{
+    TR_FUNCTION = 'F',
+    TR_TYPE = 'T',
+    TR_CALL = 'C'
+};
+
+enum trace_kind : uint8_t
+{
+    TK_NONE,
+    TK_BOOL,
+    TK_CHAR,
+    TK_SCHAR,
+    TK_UCHAR,
+    TK_WCHAR,
+    TK_SHORT,
+    TK_USHORT,
+    TK_INT,
+    TK_UINT,
+    TK_LONG,
+    TK_ULONG,
+    TK_LLONG,
+    TK_ULLONG,
+    TK_FLOAT,
+    TK_DOUBLE,
+    TK_LDOUBLE,
+    TK_POINTER,
+    TK_STRING,
+    TK_OPAQUE
+};
+
+enum trace_flags : uint8_t
+{
+    TF_RETURN = 0x1,
+    TF_ENUM = 0x2,
+    TF_TRUNCATED = 0x4,
+    TF_UNREADABLE = 0x8,
+    TF_AFTER = 0x10
+};
+
+/**
+ * Per-thread binary capture buffer
+ *
+ * Calls are assembled in a scratch record and copied into a fixed-size buffer on end_call(). The buffer is written to
+ * the thread's .abt file in one write() whenever the next record does not fit, and when the thread exits.
+ *
+ * @class TraceBuffer TraceBuffer.h
+ */
+class TraceBuffer
+{
+public:
+    TraceBuffer() = default;
+    TraceBuffer(const TraceBuffer&) = delete;
+    TraceBuffer& operator=(const TraceBuffer&) = delete;
+    ~TraceBuffer();
+
+    void begin_call(uint32_t func_id);
+    void push_value(trace_kind kind, uint8_t flags, std::string_view type_name, std::string_view name,
+                    const void* data, size_t size);
+    void end_call();
+    void flush();
+
+private:
+    void announce_function(uint32_t func_id);
+    uint16_t type_index(std::string_view type_name);
+    void append_record(trace_record_type type, const std::string& payload);
+    void open();
+
+    std::string record_;
+    std::string scratch_;
+    std::vector<char> buffer_;
+    size_t used_ = 0;
+    uint16_t nvalues_ = 0;
+    int fd_ = -1;
+    std::vector<bool> announced_;
+    std::unordered_map<const char*, uint16_t> types_;
+};
+
+extern thread_local TraceBuffer trace_buffer;
+}
+
+#endif //ABII_TRACEBUFFER_H
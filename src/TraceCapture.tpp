@@ -0,0 +1,184 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef TRACECAPTURE_H
+#define TRACECAPTURE_H
+
+#include <type_traits>
+
+namespace abii
+{
+template <typename T>
+constexpr bool is_char_v = std::is_same_v<std::remove_cv_t<T>, char> || std::is_same_v<std::remove_cv_t<T>, signed char>
+    || std::is_same_v<std::remove_cv_t<T>, unsigned char>;
+
+/**
+ * trace_kind_of() - Maps a C++ type to the trace_kind its raw bytes are recorded as
+ *
+ * @tparam T Type of the captured value
+ */
+template <typename T>
+constexpr trace_kind trace_kind_of()
+{
+    using U = std::remove_cv_t<T>;
+    if constexpr (std::is_enum_v<U>)
+        return trace_kind_of<std::underlying_type_t<U>>();
+    else if constexpr (std::is_same_v<U, bool>)
+        return TK_BOOL;
+    else if constexpr (std::is_same_v<U, char>)
+        return TK_CHAR;
+    else if constexpr (std::is_same_v<U, signed char>)
+        return TK_SCHAR;
+    else if constexpr (std::is_same_v<U, unsigned char>)
+        return TK_UCHAR;
+    else if constexpr (std::is_same_v<U, wchar_t>)
+        return TK_WCHAR;
+    else if constexpr (std::is_same_v<U, short>)
+        return TK_SHORT;
+    else if constexpr (std::is_same_v<U, unsigned short>)
+        return TK_USHORT;
+    else if constexpr (std::is_same_v<U, int>)
+        return TK_INT;
+    else if constexpr (std::is_same_v<U, unsigned int>)
+        return TK_UINT;
+    else if constexpr (std::is_same_v<U, long>)
+        return TK_LONG;
+    else if constexpr (std::is_same_v<U, unsigned long>)
+        return TK_ULONG;
+    else if constexpr (std::is_same_v<U, long long>)
+        return TK_LLONG;
+    else if constexpr (std::is_same_v<U, unsigned long long>)
+        return TK_ULLONG;
+    else if constexpr (std::is_same_v<U, float>)
+        return TK_FLOAT;
+    else if constexpr (std::is_same_v<U, double>)
+        return TK_DOUBLE;
+    else if constexpr (std::is_same_v<U, long double>)
+        return TK_LDOUBLE;
+    else if constexpr (std::is_same_v<U, std::string>)
+        return TK_STRING;
+    else if constexpr (std::is_pointer_v<U> && is_char_v<std::remove_pointer_t<U>>)
+        return TK_STRING;
+    else if constexpr (std::is_pointer_v<U> || std::is_array_v<U>)
+        return TK_POINTER;
+    else
+        return TK_OPAQUE;
+}
+
+/**
+ * pointee_bytes() - Size of what a captured pointer or array refers to, or 0 if it is not captured
+ *
+ * @tparam T Type of the captured value
+ * @param len Number of elements a pointer refers to, or 0 for one element
+ */
+template <typename T>
+size_t pointee_bytes(const size_t len)
+{
+    using U = std::remove_cv_t<T>;
+    if constexpr (std::is_array_v<U>)
+        return sizeof(U);
+    else if constexpr (std::is_pointer_v<U>)
+    {
+        using E = std::remove_cv_t<std::remove_pointer_t<U>>;
+        if constexpr (std::is_void_v<E>)
+            return len;
+        else if constexpr (is_handle_v<U> || std::is_function_v<E>)
+            return 0;
+        else if constexpr (requires { sizeof(E); })
+            return (len != 0 ? len : 1) * sizeof(E);
+        else
+            return 0;
+    }
+    else
+        return 0;
+}
+
+/**
+ * trace_arg() - Records the raw bytes of @p arg into the current thread's TraceBuffer
+ *
+ * Strings, pointers and arrays are recorded with a bounded copy of what they point to, if it is readable.
+ *
+ * @tparam T Type of the captured value
+ * @param arg Value to capture
+ * @param name Name the value is printed with
+ * @param is_return Whether the value is the function's return value
+ * @param len Number of elements a pointer refers to, or 0 for one element (strings: up to their terminator)
+ * @param after TF_AFTER to record the pointee as the callee left it, which is skipped if there is nothing to record
+ */
+template <typename T>
+void trace_arg(const T& arg, const std::string& name, const bool is_return, const size_t len = 0,
+               const uint8_t after = 0)
+{
+    constexpr auto kind = trace_kind_of<T>();
+    uint8_t flags = (is_return ? TF_RETURN : 0) | after;
+    if constexpr (std::is_enum_v<std::remove_cv_t<T>>)
+        flags |= TF_ENUM;
+
+    if constexpr (kind == TK_STRING && std::is_same_v<std::remove_cv_t<T>, std::string>)
+    {
+        const auto size = std::min<size_t>(arg.size(), TRACE_STRING_MAX);
+        if (size < arg.size())
+            flags |= TF_TRUNCATED;
+        const void* ptr = nullptr;
+        char data[sizeof(void*) + TRACE_STRING_MAX];
+        memcpy(data, &ptr, sizeof(void*));
+        memcpy(data + sizeof(void*), arg.data(), size);
+        trace_buffer.push_value(kind, flags, type_name<std::remove_cv_t<T>>(), name, data, sizeof(void*) + size);
+    }
+    else if constexpr (kind == TK_STRING)
+    {
+        char data[sizeof(void*) + TRACE_STRING_MAX];
+        const auto ptr = (const void*) arg;
+        memcpy(data, &ptr, sizeof(void*));
+        size_t size = 0;
+        const auto bounded = std::min<size_t>(len, TRACE_STRING_MAX);
+        if (const auto found = len != 0 ? readable_length(arg, bounded) : probe_terminated(ptr, 1, TRACE_STRING_MAX + 1);
+            found != -1)
+        {
+            size = std::min<size_t>(found, TRACE_STRING_MAX);
+            if (size < static_cast<size_t>(found) || (len > bounded && size == bounded))
+                flags |= TF_TRUNCATED;
+            memcpy(data + sizeof(void*), ptr, size);
+        }
+        else
+            flags |= TF_UNREADABLE;
+        trace_buffer.push_value(kind, flags, type_name<std::remove_cv_t<T>>(), name, data, sizeof(void*) + size);
+    }
+    else if constexpr (kind == TK_POINTER)
+    {
+        const auto bytes = pointee_bytes<T>(len);
+        if (after && bytes == 0)
+            return;
+        char data[sizeof(void*) + TRACE_POINTEE_MAX];
+        const auto ptr = (const void*) arg;
+        memcpy(data, &ptr, sizeof(void*));
+        size_t size = 0;
+        if (bytes != 0 && ptr != nullptr)
+        {
+            size = std::min<size_t>(bytes, TRACE_POINTEE_MAX);
+            if (size < bytes)
+                flags |= TF_TRUNCATED;
+            if (probe_readable(ptr, size))
+                memcpy(data + sizeof(void*), ptr, size);
+            else
+            {
+                flags |= TF_UNREADABLE;
+                size = 0;
+            }
+        }
+        trace_buffer.push_value(kind, flags, type_name<std::remove_cv_t<T>>(), name, data, sizeof(void*) + size);
+    }
+    else if constexpr (kind == TK_OPAQUE)
+    {
+        const auto size = std::min<size_t>(sizeof(T), TRACE_OPAQUE_MAX);
+        if (size < sizeof(T))
+            flags |= TF_TRUNCATED;
+        trace_buffer.push_value(kind, flags, type_name<std::remove_cv_t<T>>(), name, std::addressof(arg), size);
+    }
+    else
+        trace_buffer.push_value(kind, flags, type_name<std::remove_cv_t<T>>(), name, std::addressof(arg), sizeof(T));
+}
+}
+
+#endif //TRACECAPTURE_H
@@ -0,0 +1,407 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include "TraceDecoder.h"
+
+#include <cstring>
+#include <iomanip>
+#include <map>
+
+#include "libabii.h"
+
+namespace abii
+{
+namespace
+{
+struct TraceValue
+{
+    uint8_t pointer_size;
+    trace_kind kind;
+    uint8_t flags;
+    std::string type;
+    std::string name;
+    std::string data;
+};
+
+template <typename T>
+bool take(const std::string& payload, size_t& pos, T& value)
+{
+    if (pos + sizeof(T) > payload.size())
+        return false;
+    memcpy(&value, payload.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+bool take(const std::string& payload, size_t& pos, std::string& str, const size_t size)
+{
+    if (pos + size > payload.size())
+        return false;
+    str.assign(payload, pos, size);
+    pos += size;
+    return true;
+}
+
+uintptr_t pointer_value(const TraceValue& value)
+{
+    if (value.pointer_size == sizeof(uint64_t) && value.data.size() >= sizeof(uint64_t))
+    {
+        uint64_t ptr;
+        memcpy(&ptr, value.data.data(), sizeof(ptr));
+        return ptr;
+    }
+    if (value.data.size() >= sizeof(uint32_t))
+    {
+        uint32_t ptr;
+        memcpy(&ptr, value.data.data(), sizeof(ptr));
+        return ptr;
+    }
+    return 0;
+}
+
+template <typename T>
+bool fits(const TraceValue& value)
+{
+    return value.data.size() == sizeof(T) || (std::is_same_v<T, long double> && value.data.size() >= 10);
+}
+
+template <typename T>
+T scalar(const TraceValue& value)
+{
+    T t{};
+    memcpy(&t, value.data.data(), std::min(value.data.size(), sizeof(T)));
+    return t;
+}
+
+void hex_bytes(std::ostream& os, const std::string& data, const size_t start)
+{
+    os << "{";
+    for (auto i = start; i < data.size(); ++i)
+        os << (i == start ? "" : " ") << std::hex << std::setw(2) << std::setfill('0')
+            << static_cast<unsigned>(static_cast<unsigned char>(data[i])) << std::dec;
+    os << "}";
+}
+
+std::string fallback_text(const TraceValue& value)
+{
+    std::stringstream ss;
+    ss << value.name << ": (" << value.type << ") ";
+    hex_bytes(ss, value.data, 0);
+    if (value.flags & TF_TRUNCATED)
+        ss << "...";
+    return ss.str();
+}
+
+/*
+ * Scalars are rebuilt and handed to the ArgPrinter for their type; everything else is pre-formatted
+ */
+template <typename T>
+void render_scalar(const TraceValue& value, std::ostream& os)
+{
+    if (!fits<T>(value))
+    {
+        pre_fmtd_str str = fallback_text(value);
+        ArgPrinter(str, "", &os).print_arg();
+        return;
+    }
+    auto t = scalar<T>(value);
+    if (value.flags & TF_ENUM)
+    {
+        std::stringstream ss;
+        ss << value.name << ": (" << value.type << ") " << ArgPrinter(t).get_value();
+        pre_fmtd_str str = ss.str();
+        ArgPrinter(str, "", &os).print_arg();
+        return;
+    }
+    ArgPrinter(t, value.name, &os).print_arg();
+}
+
+std::string value_text(const TraceValue& value)
+{
+    std::stringstream ss;
+    switch (value.kind)
+    {
+    case TK_POINTER:
+    case TK_STRING:
+        ss << reinterpret_cast<const void*>(pointer_value(value));
+        break;
+    case TK_BOOL:
+        ss << scalar<bool>(value);
+        break;
+    case TK_CHAR:
+    case TK_SCHAR:
+        ss << static_cast<int>(scalar<signed char>(value));
+        break;
+    case TK_UCHAR:
+        ss << static_cast<int>(scalar<unsigned char>(value));
+        break;
+    case TK_SHORT:
+        ss << scalar<short>(value);
+        break;
+    case TK_USHORT:
+        ss << scalar<unsigned short>(value);
+        break;
+    case TK_WCHAR:
+    case TK_INT:
+        ss << scalar<int>(value);
+        break;
+    case TK_UINT:
+        ss << scalar<unsigned>(value);
+        break;
+    case TK_LONG:
+    case TK_LLONG:
+        if (value.data.size() == sizeof(int))
+            ss << scalar<int>(value);
+        else
+            ss << scalar<long long>(value);
+        break;
+    case TK_ULONG:
+    case TK_ULLONG:
+        if (value.data.size() == sizeof(unsigned))
+            ss << scalar<unsigned>(value);
+        else
+            ss << scalar<unsigned long long>(value);
+        break;
+    case TK_FLOAT:
+        ss << scalar<float>(value);
+        break;
+    case TK_DOUBLE:
+        ss << scalar<double>(value);
+        break;
+    case TK_LDOUBLE:
+        ss << scalar<long double>(value);
+        break;
+    default:
+        break;
+    }
+    return ss.str();
+}
+
+/*
+ * Text of a value that is not a scalar
+ */
+std::string value_line(const TraceValue& value)
+{
+    std::stringstream ss;
+    if (value.kind == TK_STRING)
+    {
+        const auto ptr = pointer_value(value);
+        std::string str = value.data.size() > value.pointer_size ? value.data.substr(value.pointer_size) : "";
+        replace_all(str, "\n", "\\n");
+        if (ptr == 0 && !(value.flags & TF_UNREADABLE))
+            ss << str;
+        else
+        {
+            ss << value.name << ": (" << value.type << ") " << reinterpret_cast<const void*>(ptr);
+            if (!(value.flags & TF_UNREADABLE))
+                ss << " {" << str << "}";
+        }
+        if (value.flags & TF_TRUNCATED)
+            ss << "...";
+    }
+    else if (value.kind == TK_POINTER)
+    {
+        ss << value.name << ": (" << value.type << ") " << reinterpret_cast<const void*>(pointer_value(value));
+        if (value.data.size() > value.pointer_size)
+        {
+            ss << " ";
+            hex_bytes(ss, value.data, value.pointer_size);
+            if (value.flags & TF_TRUNCATED)
+                ss << "...";
+        }
+    }
+    else if (value.kind == TK_NONE)
+        ss << value.name << ": (?)";
+    else
+        ss << fallback_text(value);
+    return ss.str();
+}
+
+void render_value(const TraceValue& value, std::ostream& os)
+{
+    switch (value.kind)
+    {
+    case TK_BOOL:
+        return render_scalar<bool>(value, os);
+    case TK_CHAR:
+        return render_scalar<char>(value, os);
+    case TK_SCHAR:
+        return render_scalar<signed char>(value, os);
+    case TK_UCHAR:
+        return render_scalar<unsigned char>(value, os);
+    case TK_WCHAR:
+        return render_scalar<wchar_t>(value, os);
+    case TK_SHORT:
+        return render_scalar<short>(value, os);
+    case TK_USHORT:
+        return render_scalar<unsigned short>(value, os);
+    case TK_INT:
+        return render_scalar<int>(value, os);
+    case TK_UINT:
+        return render_scalar<unsigned int>(value, os);
+    case TK_LONG:
+        return render_scalar<long>(value, os);
+    case TK_ULONG:
+        return render_scalar<unsigned long>(value, os);
+    case TK_LLONG:
+        return render_scalar<long long>(value, os);
+    case TK_ULLONG:
+        return render_scalar<unsigned long long>(value, os);
+    case TK_FLOAT:
+        return render_scalar<float>(value, os);
+    case TK_DOUBLE:
+        return render_scalar<double>(value, os);
+    case TK_LDOUBLE:
+        return render_scalar<long double>(value, os);
+    default:
+        break;
+    }
+
+    pre_fmtd_str str = value_line(value);
+    ArgPrinter(str, "", &os).print_arg();
+}
+
+/*
+ * A pointer whose pointee the callee changed is printed the way text mode prints it, before --> after
+ */
+void render_changed(const TraceValue& before, const TraceValue& after, std::ostream& os)
+{
+    const auto before_line = value_line(before);
+    const auto after_line = value_line(after);
+    pre_fmtd_str str = before_line == after_line ? before_line : print_diff(before_line, after_line);
+    ArgPrinter(str, "", &os).print_arg();
+}
+}
+
+bool decode_trace(std::istream& in, std::ostream& os)
+{
+    char magic[sizeof(TRACE_MAGIC)];
+    uint8_t version, pointer_size;
+    uint16_t reserved;
+    uint32_t pid, tid;
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0)
+    {
+        std::cerr << "Not an ABII trace file" << std::endl;
+        return false;
+    }
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&pointer_size), sizeof(pointer_size));
+    in.read(reinterpret_cast<char*>(&reserved), sizeof(reserved));
+    in.read(reinterpret_cast<char*>(&pid), sizeof(pid));
+    in.read(reinterpret_cast<char*>(&tid), sizeof(tid));
+    // Version 1 traces only lack the pointees, which decode the same way
+    if (!in || version < 1 || version > TRACE_VERSION)
+    {
+        std::cerr << "Unsupported ABII trace version" << std::endl;
+        return false;
+    }
+    os << "Decoding " << static_cast<int>(pointer_size) * 8 << "-bit ABII trace of process: " << pid << " thread: "
+        << tid << "..." << std::endl << std::endl;
+
+    std::map<uint32_t, std::string> functions;
+    std::map<uint16_t, std::string> types;
+    std::string payload;
+    const auto old_prefix = prefix;
+
+    while (true)
+    {
+        uint8_t type;
+        uint32_t size;
+        if (!in.read(reinterpret_cast<char*>(&type), sizeof(type)))
+            break;
+        if (!in.read(reinterpret_cast<char*>(&size), sizeof(size)))
+            return false;
+        payload.resize(size);
+        if (!in.read(payload.data(), size))
+        {
+            std::cerr << "Truncated ABII trace record" << std::endl;
+            return false;
+        }
+
+        size_t pos = 0;
+        switch (type)
+        {
+        case TR_FUNCTION:
+            {
+                uint32_t id;
+                if (!take(payload, pos, id))
+                    return false;
+                functions[id] = payload.substr(pos);
+                break;
+            }
+        case TR_TYPE:
+            {
+                uint16_t index;
+                if (!take(payload, pos, index))
+                    return false;
+                types[index] = payload.substr(pos);
+                break;
+            }
+        case TR_CALL:
+            {
+                uint64_t timestamp;
+                uint32_t func_id;
+                uint16_t count;
+                if (!take(payload, pos, timestamp) || !take(payload, pos, func_id) || !take(payload, pos, count))
+                    return false;
+
+                std::vector<TraceValue> values(count);
+                const TraceValue* ret = nullptr;
+                for (auto& value: values)
+                {
+                    uint8_t kind;
+                    uint16_t type_index, name_size;
+                    uint32_t data_size;
+                    if (!take(payload, pos, kind) || !take(payload, pos, value.flags) || !take(payload, pos, type_index)
+                        || !take(payload, pos, name_size) || !take(payload, pos, data_size)
+                        || !take(payload, pos, value.name, name_size) || !take(payload, pos, value.data, data_size))
+                        return false;
+                    value.pointer_size = pointer_size;
+                    value.kind = static_cast<trace_kind>(kind);
+                    value.type = types[type_index];
+                    if (value.flags & TF_RETURN)
+                        ret = &value;
+                }
+
+                os << "[" << timestamp / 1000000000 << "." << std::setw(9) << std::setfill('0')
+                    << timestamp % 1000000000 << std::setfill(' ') << "] " << functions[func_id] << "(";
+                auto first = true;
+                for (const auto& value: values)
+                    if (!(value.flags & (TF_RETURN | TF_AFTER)))
+                    {
+                        os << (first ? "" : ", ") << value.name;
+                        first = false;
+                    }
+                os << ")";
+                if (ret != nullptr)
+                    os << " = " << value_text(*ret);
+                os << std::endl;
+
+                prefix = "\t";
+                for (const auto& value: values)
+                {
+                    if (value.flags & (TF_RETURN | TF_AFTER))
+                        continue;
+                    const auto after = std::ranges::find_if(values, [&](const TraceValue& other) {
+                        return other.flags & TF_AFTER && other.name == value.name;
+                    });
+                    if (after != values.end())
+                        render_changed(value, *after, os);
+                    else
+                        render_value(value, os);
+                }
+                if (ret != nullptr)
+                    render_value(*ret, os);
+                prefix = old_prefix;
+                os << std::endl;
+                break;
+            }
+        default:
+            std::cerr << "Unknown ABII trace record type " << static_cast<int>(type) << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+}
@@ -0,0 +1,26 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#ifndef ABII_TRACEDECODER_H
+#define ABII_TRACEDECODER_H
+
+#include <istream>
+#include <ostream>
+
+namespace abii
+{
+/**
+ * decode_trace() - Renders a binary trace written by TraceBuffer as text
+ *
+ * Scalar values are printed with the matching ArgPrinter specialization, so the output uses the same layout as a log
+ * written in text mode.
+ *
+ * @param in Stream positioned at the start of a .abt file
+ * @param os Stream the rendered calls are written to
+ * @return false if the input is not a trace file or is truncated
+ */
+bool decode_trace(std::istream& in, std::ostream& os);
+}
+
+#endif //ABII_TRACEDECODER_H
@@ -2,7 +2,6 @@
 // Created by Trent Tanchin on 12/9/25.
 //
 
-#include <stdexcept>
 #include <string>
 #include <unistd.h>
 #include <sys/stat.h>
@@ -11,35 +10,61 @@
 
 namespace abii
 {
-std::string get_logfname()
-{
-    auto pid = std::to_string(getpid());
-    auto tid = std::to_string(gettid());
-    auto path = "/proc/" + pid + "/comm";
-    std::ifstream fcomm(path);
-    if (!fcomm.is_open())
-        throw std::runtime_error("Could not open " + path);
-
-    std::string comm;
-    std::getline(fcomm, comm);
-    return std::string(getenv("HOME")) + "/abii_log/" + comm + "_" + pid + "_" + tid + ".txt";
-}
-
 __attribute__((constructor))
 void abii_init()
 {
     mkdir((std::string(getenv("HOME")) + "/abii_log").c_str(), 0775);
+    resolve_real_functions();
+    // Seed the address map while only the startup objects are loaded
+    address_map();
+
+    if (const char* env_mode = getenv("ABII_MODE"); env_mode != nullptr)
+    {
+        if (strcmp(env_mode, "binary") == 0)
+            mode = BINARY_MODE;
+        else if (strcmp(env_mode, "stats") == 0)
+            mode = STATS_MODE;
+        else if (strcmp(env_mode, "text") != 0)
+            std::cerr << "Unknown ABII_MODE `" << env_mode << "`, using text" << std::endl;
+    }
+
+    if (const char* env_filter = getenv("ABII_FILTER"); env_filter != nullptr)
+    {
+        configure_filter(env_filter);
+        auto reload_signal = 0;
+        if (const char* env_signal = getenv("ABII_FILTER_SIGNAL"); env_signal != nullptr)
+        {
+            reload_signal = parse_signal(env_signal);
+            if (reload_signal == 0)
+                std::cerr << "Unknown ABII_FILTER_SIGNAL `" << env_signal << "`, only polling the rule file" << std::endl;
+        }
+        start_filter_watcher(reload_signal);
+    }
+    if (const char* env_timing = getenv("ABII_TIMING"); env_timing != nullptr && strcmp(env_timing, "0") != 0)
+    {
+        timing = true;
+        time_real_functions();
+        start_timing();
+    }
+    if (const char* env_sample = getenv("ABII_SAMPLE"); env_sample != nullptr)
+        configure_sampling(env_sample);
+    if (const char* env_dedup = getenv("ABII_DEDUP"); env_dedup != nullptr && strcmp(env_dedup, "0") != 0)
+        dedup = true;
 
-    abii_stream = std::ofstream(get_logfname(), std::ios::app);
-    if (!abii_stream.is_open())
-        throw std::runtime_error("Could not open " + get_logfname());
+    // Stats mode only writes the summary at unload
+    if (mode != STATS_MODE)
+    {
+        configure_compression();
+        start_writer();
 #ifndef BIT32
-    abii_stream << "Loading 64-bit ABII in process: " << getpid() << " thread: " << gettid() << "..."
-        << std::endl << std::endl;
+        open_process_log("Loading 64-bit ABII in process: " + std::to_string(getpid()) + " thread: " +
+                         std::to_string(gettid()) + "...\n\n");
 #else
-    abii_stream << "Loading 32-bit ABII in process: " << getpid() << " thread: " << gettid() << "..."
-        << std::endl << std::endl;
+        open_process_log("Loading 32-bit ABII in process: " + std::to_string(getpid()) + " thread: " +
+                         std::to_string(gettid()) + "...\n\n");
 #endif
+    }
+    loaded = true;
     ENABLE_OVERRIDES
 }
 
@@ -47,7 +72,32 @@ __attribute__((destructor))
 static void abii_destructor()
 {
     DISABLE_OVERRIDES
-    std::ofstream os(get_logfname(), std::ios::app);
+    loaded = false;
+    stop_filter_watcher();
+    // Everything queued so far reaches the log before the unload message
+    stop_writer();
+    std::ofstream stats_file;
+    if (mode == STATS_MODE)
+    {
+        stats_file.open(get_process_logfname(".stats"), std::ios::app);
+        write_stats(stats_file);
+    }
+    // The summary is one last record; this thread's abii_stream may already be destroyed
+    LogStream log;
+    std::ostream& os = mode == STATS_MODE ? static_cast<std::ostream&>(stats_file) : log;
+    if (sampling)
+    {
+        uint64_t total = 0;
+        for (uint32_t id = 0; id < function_count(); ++id)
+            if (const auto& func = get_function(id); func.sample.dropped != 0)
+            {
+                os << "[ABII: " << func.sample.dropped << " calls to " << func.name << " not logged]" << std::endl;
+                total += func.sample.dropped;
+            }
+        os << "[ABII: " << total << " calls not logged in total]" << std::endl;
+    }
+    if (timing)
+        print_latency_table(os);
 #ifndef BIT32
     os << "Unloading 64-bit ABII in process: " << getpid() << " thread: " << gettid() << "..."
         << std::endl;
@@ -55,12 +105,8 @@ static void abii_destructor()
     os << "Unloading 32-bit ABII in process: " << getpid() << " thread: " << gettid() << "..."
         << std::endl;
 #endif
-    os.flush();
-    os.close();
-    if (abii_stream.is_open())
-    {
-        abii_stream.flush();
-        abii_stream.close();
-    }
+    log.end_record();
+    log.close();
+    close_process_log();
 }
 } // namespace abii
@@ -4,12 +4,205 @@
 
 #include "libabii.h"
 
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <unordered_map>
 
 namespace abii
 {
-thread_local bool redirect = false;
+abii_mode mode = TEXT_MODE;
+std::atomic_bool loaded = false;
+// Threads started while ABII is loaded turn it on in pthread_create(), see threadhooks.cpp
+thread_local constinit bool redirect = false;
 thread_local std::string prefix;
-thread_local std::vector<uintptr_t> used_addrs = {};
-thread_local std::ofstream abii_stream;
+thread_local AddressSet used_addrs;
+bool dedup = false;
+thread_local AddressTable<VisitedObject> visited;
+thread_local size_t visit_depth = 0;
+thread_local LogStream abii_stream;
+
+std::string get_process_logfname(const std::string& ext)
+{
+    // comm is read once per process; a forked child reads its own
+    static std::mutex mutex;
+    static pid_t cached_pid = 0;
+    static std::string path_prefix;
+    std::lock_guard lock(mutex);
+    if (const auto pid = getpid(); pid != cached_pid)
+    {
+        const auto pid_str = std::to_string(pid);
+        const auto path = "/proc/" + pid_str + "/comm";
+        std::ifstream fcomm(path);
+        if (!fcomm.is_open())
+            throw std::runtime_error("Could not open " + path);
+
+        std::string comm;
+        std::getline(fcomm, comm);
+        path_prefix = std::string(getenv("HOME")) + "/abii_log/" + comm + "_" + pid_str;
+        cached_pid = pid;
+    }
+    return path_prefix + ext;
+}
+
+std::string get_logfname(const std::string& ext)
+{
+    return get_process_logfname("_" + std::to_string(gettid()) + ext);
+}
+
+std::string_view demangle_cached(const std::type_info& type)
+{
+    // Keyed by the mangled name's address, which is unique to each type within one object
+    thread_local std::unordered_map<const char*, std::string> names;
+    auto it = names.find(type.name());
+    if (it == names.end())
+        it = names.emplace(type.name(), demangle(type.name())).first;
+    return it->second;
+}
+
+namespace
+{
+constexpr size_t PROBE_BATCH = 64;
+
+std::atomic_bool use_pipe_probe = false;
+
+uintptr_t page_size()
+{
+    static const auto size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+/*
+ * Fallback for kernels or sandboxes without process_vm_readv(): write() returns EFAULT instead of faulting
+ */
+bool pipe_probe(const uintptr_t page, const size_t count)
+{
+    static thread_local struct ProbePipe
+    {
+        int fds[2] = {-1, -1};
+
+        ProbePipe()
+        {
+            if (pipe2(fds, O_NONBLOCK | O_CLOEXEC) == -1)
+                std::cerr << "Pipe creation failed" << std::endl;
+        }
+
+        ~ProbePipe()
+        {
+            if (fds[0] != -1)
+                close(fds[0]);
+            if (fds[1] != -1)
+                close(fds[1]);
+        }
+    } probe_pipe;
+
+    if (probe_pipe.fds[1] == -1)
+        return false;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (write(probe_pipe.fds[1], reinterpret_cast<const void*>(page + i * page_size()), 1) != 1)
+            return false;
+        char c;
+        read(probe_pipe.fds[0], &c, 1);
+    }
+    return true;
+}
+
+/*
+ * Reads one byte from each of @p count pages starting at @p page, batching the pages into as few syscalls as possible
+ */
+bool probe_pages(const uintptr_t page, const size_t count)
+{
+    if (use_pipe_probe.load(std::memory_order_relaxed))
+        return pipe_probe(page, count);
+
+    iovec remote[PROBE_BATCH];
+    char bytes[PROBE_BATCH];
+    for (size_t done = 0; done < count;)
+    {
+        const auto batch = std::min(count - done, PROBE_BATCH);
+        for (size_t i = 0; i < batch; ++i)
+            remote[i] = {reinterpret_cast<void*>(page + (done + i) * page_size()), 1};
+        const iovec local = {bytes, batch};
+        const auto nbytes = process_vm_readv(getpid(), &local, 1, remote, batch, 0);
+        if (nbytes == -1 && (errno == ENOSYS || errno == EPERM))
+        {
+            use_pipe_probe.store(true, std::memory_order_relaxed);
+            return pipe_probe(page + done * page_size(), count - done);
+        }
+        if (nbytes != static_cast<ssize_t>(batch))
+            return false;
+        done += batch;
+    }
+    return true;
+}
+}
+
+bool probe_readable(const void* ptr, size_t size)
+{
+    if (ptr == nullptr)
+        return false;
+    if (size == 0)
+        size = 1;
+    const auto mask = ~(page_size() - 1);
+    const auto start = reinterpret_cast<uintptr_t>(ptr);
+    if (start + size - 1 < start)
+        return false;
+    if (address_map().readable_extent(start) >= size)
+        return true;
+    const auto first = start & mask;
+    const auto last = (start + size - 1) & mask;
+    return probe_pages(first, (last - first) / page_size() + 1);
+}
+
+ssize_t probe_terminated(const void* ptr, const size_t elem_size, const size_t max)
+{
+    if (ptr == nullptr || elem_size == 0)
+        return -1;
+    const auto mask = ~(page_size() - 1);
+    const auto start = reinterpret_cast<uintptr_t>(ptr);
+    auto readable_end = start & mask;
+    size_t i = 0;
+    while (max == 0 || i < max)
+    {
+        const auto elem = start + i * elem_size;
+        if (elem + elem_size < elem)
+            return -1;
+        if (elem + elem_size > readable_end)
+        {
+            if (const auto extent = address_map().readable_extent(elem); extent >= elem_size)
+            {
+                readable_end = elem + extent;
+                continue;
+            }
+            const auto first = readable_end & mask;
+            const auto last = (elem + elem_size - 1) & mask;
+            if (!probe_pages(first, (last - first) / page_size() + 1))
+                return -1;
+            readable_end = last + page_size();
+        }
+
+        // Everything up to readable_end is known to be mapped, so it can be scanned directly
+        auto count = (readable_end - elem) / elem_size;
+        if (max != 0)
+            count = std::min(count, max - i);
+        if (elem_size == 1)
+        {
+            if (const auto nul = memchr(reinterpret_cast<const void*>(elem), 0, count); nul != nullptr)
+                return i + (static_cast<const char*>(nul) - reinterpret_cast<const char*>(elem));
+            i += count;
+            continue;
+        }
+        for (size_t j = 0; j < count; ++j, ++i)
+        {
+            const auto bytes = reinterpret_cast<const char*>(start + i * elem_size);
+            if (std::all_of(bytes, bytes + elem_size, [](const char c) { return c == 0; }))
+                return i;
+        }
+    }
+    return max;
+}
 }
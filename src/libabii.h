@@ -6,16 +6,36 @@
 #define LIBABII_H
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <cxxabi.h>
 #include <dlfcn.h>
 #include <fcntl.h>
+#include <optional>
 #include <quadmath.h>
 #include <sstream>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
 #include <unistd.h>
 #include <vector>
 
+#include "AddressMap.h"
+#include "AddressSet.h"
+#include "Arena.h"
+#include "Compression.h"
+#include "EnumDecoder.h"
+#include "Filter.h"
+#include "FormatBuffer.h"
+#include "FunctionRegistry.h"
+#include "Latency.h"
 #include "Logger.h"
+#include "LogWriter.h"
+#include "PrinterConfig.h"
+#include "RealFunction.h"
+#include "Stats.h"
+#include "SymbolCache.h"
+#include "TraceBuffer.h"
 #include "utils.h"
 
 #define ENABLE_OVERRIDES abii::redirect = true;
@@ -27,43 +47,53 @@
 #define TRACE_LOGGER
 #endif
 
+/*
+ * Slots declared with REAL_FUNCTION are references and never null, so this expands to nothing for them; plugins still
+ * declaring them as static decltype(&func) real_func = nullptr; get them resolved on first use
+ */
+#define RESOLVE_REAL_FUNCTION(real_func) \
+    if constexpr (!std::is_reference_v<decltype(real_func)>) \
+        abii::resolve_legacy_slot(real_func, __func__);
+
 #define OVERRIDE_PREFIX(real_func) \
-    if (abii::redirect) \
+    static std::atomic<abii::FunctionInfo*> abii_func_slot{nullptr}; \
+    if (abii::redirect && abii::should_log(abii_func_slot, __func__)) \
     { \
         DISABLE_OVERRIDES \
         TRACE_LOGGER \
-        if ((real_func) == nullptr) \
-        { \
-            (real_func) = (decltype(real_func)) dlsym(RTLD_NEXT, __func__); \
-            if ((real_func) == nullptr) \
-                std::cerr << "Error in `dlsym`: " << dlerror() << std::endl; \
-        } \
+        RESOLVE_REAL_FUNCTION(real_func) \
+        auto& abii_func = *abii_func_slot.load(std::memory_order_relaxed); \
         abii::prefix = ""; \
-        const auto abii_args = new abii::ArgsPrinter();
+        const auto abii_arena_marker = abii::arena().begin_scope(); \
+        const auto abii_args = new abii::ArgsPrinter(abii_func); \
+        abii::arm_real_call(reinterpret_cast<const void*>(&(real_func)));
 
 #define OVERRIDE_SUFFIX(real_func, ret) \
         abii_args->print_args(); \
-        abii::abii_stream << std::endl; \
+        if (abii::mode == abii::TEXT_MODE) \
+        { \
+            abii::abii_stream << std::endl; \
+            abii::abii_stream.end_record(); \
+        } \
         delete abii_args; \
+        abii::arena().end_scope(abii_arena_marker); \
         ENABLE_OVERRIDES \
         return ret; \
     } \
-    if ((real_func) == nullptr) \
-    { \
-        (real_func) = (decltype(real_func)) dlsym(RTLD_NEXT, __func__); \
-        if ((real_func) == nullptr) \
-            std::cerr << "Error in `dlsym`: " << dlerror() << std::endl; \
-    }
+    RESOLVE_REAL_FUNCTION(real_func)
 
 #define OVERRIDE_STREAM_PREFIX \
-    const auto abii_old_prefix = abii::prefix; \
-    abii::prefix = abii::prefix + "\t"; \
+    const auto abii_old_prefix_size = abii::prefix.size(); \
+    abii::prefix += '\t'; \
     os << std::endl; \
+    const auto abii_arena_marker = abii::arena().begin_scope(); \
     const auto abii_args = new abii::ArgsPrinter();
 
 #define OVERRIDE_STREAM_SUFFIX \
     abii_args->print_args(); \
-    abii::prefix = abii_old_prefix; \
+    delete abii_args; \
+    abii::arena().end_scope(abii_arena_marker); \
+    abii::prefix.resize(abii_old_prefix_size); \
     return os;
 
 #define OVERRIDE_VARIADIC_PREFIX(real_func, fmt) \
@@ -75,16 +105,17 @@
         va_start(abii_vargs, fmt); \
         abii_args->print_args(); \
         va_end(abii_vargs); \
-        abii::abii_stream << std::endl; \
+        if (abii::mode == abii::TEXT_MODE) \
+        { \
+            abii::abii_stream << std::endl; \
+            abii::abii_stream.end_record(); \
+        } \
+        delete abii_args; \
+        abii::arena().end_scope(abii_arena_marker); \
         ENABLE_OVERRIDES \
         __builtin_return(abii_ret); \
     } \
-    if ((real_func) == nullptr) \
-    { \
-        (real_func) = (decltype(real_func)) dlsym(RTLD_NEXT, __func__); \
-        if ((real_func) == nullptr) \
-            std::cerr << "Error in `dlsym`: " << dlerror() << std::endl; \
-    } \
+    RESOLVE_REAL_FUNCTION(real_func) \
     const auto abii_bi_vargs = __builtin_apply_args();
 
 #define OVERRIDE_VALIST_PREFIX(real_func, fmt, valist) \
@@ -124,8 +155,20 @@
 
 namespace abii
 {
+/**
+ * Base class of every printer
+ *
+ * Printers are owned by the ArgsPrinter they are pushed to, which deletes them. Inside an override they are allocated
+ * from the calling thread's arena and their memory is reused once the intercepted call returns; printers built
+ * anywhere else come from the heap.
+ *
+ * @struct VirtArgPrinter libabii.h
+ */
 struct VirtArgPrinter
 {
+    static void* operator new(const size_t size) { return allocate_object(size); }
+    static void operator delete(void* ptr) { deallocate_object(ptr); }
+
     virtual ~VirtArgPrinter() = default;
     [[nodiscard]] virtual std::string get_name() const = 0;
     virtual void set_name(const std::string& name) = 0;
@@ -135,6 +178,33 @@ struct VirtArgPrinter
     virtual void set_print_endl(bool print_endl) = 0;
     [[nodiscard]] virtual std::string get_value() const = 0;
     virtual void print_arg() = 0;
+
+    virtual void capture(const bool is_return) const
+    {
+        trace_buffer.push_value(TK_NONE, is_return ? TF_RETURN : 0, "", get_name(), nullptr, 0);
+    }
+
+    /**
+     * capture_after() - Records what the argument points to again once the call returned, if the callee may write it
+     */
+    virtual void capture_after() const {}
+
+    /**
+     * snapshot() - Appends the raw bytes the printed argument depends on to @p bytes
+     *
+     * @return false if the argument cannot be snapshotted and has to be re-rendered after the call
+     */
+    virtual bool snapshot([[maybe_unused]] std::string& bytes) const { return false; }
+
+    /**
+     * is_error() - Whether the argument, as a return value, reports a failure; see error_value()
+     */
+    [[nodiscard]] virtual bool is_error() const { return false; }
+
+    /**
+     * buffer_bytes() - Size of the buffer the argument points to, if a length was given
+     */
+    [[nodiscard]] virtual size_t buffer_bytes() const { return 0; }
 };
 
 typedef std::string pre_fmtd_str;
@@ -143,10 +213,85 @@ typedef std::vector<VirtArgPrinter*> ArgsVector;
 template<typename T = unsigned long long>
 using defines_map = std::vector<std::pair<T, std::string>>;
 
-extern thread_local bool redirect;
+enum abii_mode
+{
+    TEXT_MODE,
+    BINARY_MODE,
+    STATS_MODE
+};
+
+extern abii_mode mode;
+extern std::atomic_bool loaded; // Between abii_init() and abii_destructor()
+extern thread_local constinit bool redirect;
 extern thread_local std::string prefix;
-extern thread_local std::vector<uintptr_t> used_addrs;
-extern thread_local std::ofstream abii_stream;
+extern thread_local AddressSet used_addrs; // Pointers whose contents are being printed
+extern thread_local LogStream abii_stream;
+
+/**
+ * dedup - Whether objects reached more than once while printing an argument are only printed the first time, set
+ * from ABII_DEDUP
+ */
+extern bool dedup;
+
+struct VisitedObject
+{
+    const std::type_info* type;
+    size_t id;
+};
+
+extern thread_local AddressTable<VisitedObject> visited;
+extern thread_local size_t visit_depth;
+
+/**
+ * Scope of one argument's rendering, which numbers the objects it visits from 1
+ *
+ * Nested scopes, like the ArgsPrinter of a custom printer, share the numbering of the outermost one.
+ *
+ * @struct VisitScope libabii.h
+ */
+struct VisitScope
+{
+    VisitScope()
+    {
+        if (visit_depth++ == 0)
+            visited.clear();
+    }
+
+    ~VisitScope() { --visit_depth; }
+
+    VisitScope(const VisitScope&) = delete;
+    VisitScope& operator=(const VisitScope&) = delete;
+};
+
+
+std::string get_logfname(const std::string& ext = ".txt");
+
+/**
+ * get_process_logfname() - Like get_logfname(), for files shared by every thread of the process
+ */
+std::string get_process_logfname(const std::string& ext);
+
+/**
+ * should_log() - Registers the calling override on first use and applies its filter and sampling rule
+ *
+ * Calls that are filtered out or not sampled skip the logging block of OVERRIDE_PREFIX entirely and go straight to the real function.
+ *
+ * @param slot Function-local registry entry, null until the first call
+ * @param name Name of the intercepted function
+ */
+inline bool should_log(std::atomic<FunctionInfo*>& slot, const char* name)
+{
+    auto func = slot.load(std::memory_order_acquire);
+    if (func == nullptr)
+    {
+        // Registration allocates, which may itself be intercepted
+        redirect = false;
+        func = &register_function(name);
+        slot.store(func, std::memory_order_release);
+        redirect = true;
+    }
+    return func->enabled.load(std::memory_order_relaxed) && (!sampling || sample(func->sample));
+}
 
 inline std::ostream& operator<<(std::ostream& os, const wchar_t& wc)
 {
@@ -172,24 +317,10 @@ inline void* _get_real_symbol(const char* symbol_name)
         return nullptr;
     }
 
-    std::string line;
     std::vector<std::string> candidate_paths;
-
-    while (std::getline(maps, line))
-    {
-        if (auto pos = line.find("libc.so"); pos != std::string::npos)
-        {
-            std::istringstream iss(line);
-            std::string path;
-            if (std::string addr, perms, offset, dev, inode; !(iss >> addr >> perms >> offset >> dev >> inode))
-                continue;
-            std::getline(iss, path);
-            // Remove leading spaces
-            if (size_t start = path.find_first_not_of(' '); start != std::string::npos)
-                path = path.substr(start);
-            candidate_paths.push_back(path);
-        }
-    }
+    for (auto& entry: parse_maps(maps))
+        if (entry.path.find("libc.so") != std::string::npos)
+            candidate_paths.push_back(std::move(entry.path));
 
     for (auto& path: candidate_paths)
     {
@@ -208,200 +339,245 @@ inline void* _get_real_symbol(const char* symbol_name)
     return nullptr;
 }
 
+/**
+ * probe_readable() - Checks whether [@p ptr, @p ptr + @p size) can be read without faulting
+ *
+ * Readability is checked once per page with process_vm_readv() on our own process, so the cost does not depend on the
+ * size of the range.
+ *
+ * @param ptr Start of the range
+ * @param size Size of the range in bytes
+ * @return true if every page overlapping the range is readable
+ */
+bool probe_readable(const void* ptr, size_t size);
+
+/**
+ * probe_terminated() - Checks a zero-terminated array for readability and finds its terminator in the same pass
+ *
+ * Each page is probed once, right before the first element on it is scanned.
+ *
+ * @param ptr Start of the array
+ * @param elem_size Size of one element; the terminator is an element whose bytes are all zero
+ * @param max Maximum number of elements to scan, or 0 for no limit
+ * @return Number of elements before the terminator (@p max if none was found), or -1 if an unreadable page came first
+ */
+ssize_t probe_terminated(const void* ptr, size_t elem_size, size_t max = 0);
+
+template<typename T>
+constexpr bool is_string_char_v = std::is_same_v<std::remove_cv_t<T>, char>
+    || std::is_same_v<std::remove_cv_t<T>, wchar_t>;
+
+/**
+ * bomb_detector() - Checks whether @p ptr can be dereferenced
+ *
+ * @param ptr Pointer to check
+ * @param size Number of elements to check, or 0 for a single element. Strings of char or wchar_t are checked up to
+ * their terminator instead
+ * @return true if the memory is readable
+ */
 template<typename T>
 bool bomb_detector(T* ptr, size_t size = 0)
 {
     if (ptr == nullptr)
         return false;
 
-    int pipefds[2];
-    if (pipe(pipefds) == -1)
+    if constexpr (std::is_void_v<T> || std::is_function_v<T>)
+        return probe_readable((const void*) ptr, size != 0 ? size : 1);
+    else
     {
-        std::cerr << "Pipe creation failed" << std::endl;
-        return false;
+        if constexpr (is_string_char_v<T>)
+            if (size == 0)
+                return probe_terminated((const void*) ptr, sizeof(T)) != -1;
+        return probe_readable((const void*) ptr, (size != 0 ? size : 1) * sizeof(T));
     }
-
-    const int flags = fcntl(pipefds[1], F_GETFL, 0);
-    fcntl(pipefds[1], F_SETFL, flags | O_NONBLOCK);
-
-    const ssize_t nbytes = write(pipefds[1], (void*) ptr, size != 0 ? size : sizeof(T));
-
-    close(pipefds[0]);
-    close(pipefds[1]);
-
-    return nbytes == (size != 0 ? size : sizeof(T));
 }
 
-template<>
-inline bool bomb_detector<char>(char* ptr, size_t size)
+/**
+ * enter_address() - Ends the line of a pointer whose contents are about to be printed, one level deeper
+ *
+ * If the contents are already being printed further up, prints [RECURSION] instead. With dedup, the first time an
+ * object is printed its line is tagged with [#<id>], and later visits print [SEE #<id>] instead of the contents.
+ *
+ * @return true if the contents must be printed, followed by leave_address()
+ */
+template<typename T>
+bool enter_address(std::ostream& os, const T* ptr)
 {
-    if (ptr == nullptr)
-        return false;
-
-    do
+    const auto addr = reinterpret_cast<uintptr_t>(ptr);
+    if (used_addrs.contains(addr))
     {
-        int pipefds[2];
-        if (pipe(pipefds) == -1)
+        os << std::endl << prefix << "[RECURSION]";
+        return false;
+    }
+    // Strings read better repeated than referenced
+    if constexpr (!is_string_char_v<T>)
+        if (dedup)
         {
-            std::cerr << "Pipe creation failed" << std::endl;
-            return false;
+            if (const auto seen = visited.find(addr); seen == nullptr)
+            {
+                visited.insert(addr, {&typeid(T), visited.size() + 1});
+                os << " [#" << visited.size() << "]";
+            }
+            else if (*seen->type == typeid(T))
+            {
+                os << std::endl << prefix << "[SEE #" << seen->id << "]";
+                return false;
+            }
         }
-
-        const int flags = fcntl(pipefds[1], F_GETFL, 0);
-        fcntl(pipefds[1], F_SETFL, flags | O_NONBLOCK);
-        const ssize_t nbytes = write(pipefds[1], ptr, size != 0 ? size : sizeof(char));
-        close(pipefds[0]);
-        close(pipefds[1]);
-        if (nbytes != (size != 0 ? size : sizeof(char)))
-            return false;
-        if (*ptr == 0)
-            break;
-    } while (*ptr++ != 0 && size == 0);
-
+    os << std::endl;
+    used_addrs.push(addr);
     return true;
 }
 
-template<>
-inline bool bomb_detector<const char>(const char* ptr, size_t size)
+inline void leave_address() { used_addrs.pop(); }
+
+/**
+ * readable_length() - Checks a string for readability and returns its length
+ *
+ * @param ptr String to check
+ * @param size Number of characters the string is known to hold, or 0 if it is terminated
+ * @return Number of characters before the terminator (at most @p size), or -1 if the string is not readable
+ */
+template<typename T>
+ssize_t readable_length(T* ptr, const size_t size = 0)
 {
     if (ptr == nullptr)
-        return false;
-
-    do
-    {
-        int pipefds[2];
-        if (pipe(pipefds) == -1)
-        {
-            std::cerr << "Pipe creation failed" << std::endl;
-            return false;
-        }
-
-        const int flags = fcntl(pipefds[1], F_GETFL, 0);
-        fcntl(pipefds[1], F_SETFL, flags | O_NONBLOCK);
-        const ssize_t nbytes = write(pipefds[1], ptr, size != 0 ? size : sizeof(const char));
-        close(pipefds[0]);
-        close(pipefds[1]);
-        if (nbytes != (size != 0 ? size : sizeof(const char)))
-            return false;
-        if (*ptr == 0)
-            break;
-    } while (*ptr++ != 0 && size == 0);
-
-    return true;
+        return -1;
+    if (size == 0)
+        return probe_terminated((const void*) ptr, sizeof(T));
+    if (!probe_readable((const void*) ptr, size * sizeof(T)))
+        return -1;
+    return std::find(ptr, ptr + size, std::remove_cv_t<T>{}) - ptr;
 }
 
 inline std::string demangle(const std::string& name)
 {
-    const auto t = __cxxabiv1::__cxa_demangle(name.c_str(), nullptr, nullptr, nullptr);
+    const std::unique_ptr<char, decltype(&free)> t(__cxxabiv1::__cxa_demangle(name.c_str(), nullptr, nullptr, nullptr),
+                                                   free);
     if (t == nullptr)
         return name;
-    return t;
+    return t.get();
 }
 
+/**
+ * demangle_cached() - Demangles the name of @p type once per thread and type
+ *
+ * @return View of the demangled name, valid until the calling thread exits
+ */
+std::string_view demangle_cached(const std::type_info& type);
+
 template<typename T>
-std::string get_type([[maybe_unused]] T& i) requires std::is_polymorphic_v<T>
+constexpr std::string_view raw_type_name()
 {
-    const void* vptr = *(void**) &i;
-    if (const void* rtti = vptr ? ((void**) vptr)[-1] : nullptr; rtti != nullptr)
-        return demangle(typeid(i).name());
-    return demangle(typeid(T).name());
+    return __PRETTY_FUNCTION__;
 }
 
+// Where the type sits in raw_type_name(), measured once on a known type
+constexpr size_t TYPE_NAME_PREFIX = raw_type_name<int>().find("= int") + 2;
+constexpr size_t TYPE_NAME_SUFFIX = raw_type_name<int>().size() - TYPE_NAME_PREFIX - 3;
+
+/**
+ * type_name() - Name of @p T, computed at compile time
+ */
 template<typename T>
-std::string get_type([[maybe_unused]] T& i) requires (!std::is_polymorphic_v<T>)
+constexpr std::string_view type_name()
 {
-    return demangle(typeid(i).name());
+    constexpr auto raw = raw_type_name<T>();
+    return raw.substr(TYPE_NAME_PREFIX, raw.size() - TYPE_NAME_PREFIX - TYPE_NAME_SUFFIX);
 }
 
+/*
+ * get_type() follows typeid(): cv-qualifiers are dropped, and polymorphic objects are named after their dynamic type
+ */
 template<typename T>
-std::string get_type([[maybe_unused]] const T& i) requires (std::is_const_v<T> && std::is_polymorphic_v<T>)
+std::string_view get_type([[maybe_unused]] T& i) requires std::is_polymorphic_v<T>
 {
     const void* vptr = *(void**) &i;
     if (const void* rtti = vptr ? ((void**) vptr)[-1] : nullptr; rtti != nullptr)
-        return demangle(typeid(i).name());
-    return demangle(typeid(T).name());
+        return demangle_cached(typeid(i));
+    return type_name<std::remove_cv_t<T>>();
 }
 
 template<typename T>
-std::string get_type([[maybe_unused]] const T& i) requires (std::is_const_v<T> && !std::is_polymorphic_v<T>)
+constexpr std::string_view get_type([[maybe_unused]] T& i) requires (!std::is_polymorphic_v<T>)
 {
-    return demangle(typeid(i).name());
+    return type_name<std::remove_cv_t<T>>();
 }
 
-inline std::string get_symbol_name(const void* ptr)
+/**
+ * get_symbol_name() - Returns the demangled name of the dynamic symbol containing @p ptr, or an empty view
+ *
+ * The view is only valid until the calling thread looks up another symbol.
+ */
+inline std::string_view get_symbol_name(const void* ptr)
 {
     if (ptr == nullptr)
         return "";
-    Dl_info info;
-    if (dladdr(ptr, &info) && info.dli_sname != nullptr && info.dli_saddr != nullptr)
-        return demangle(info.dli_sname);
-    return "";
+    return symbol_cache().lookup(ptr);
 }
 
+/*
+ * print_enum_entry() and print_or_enum_entries() scan every map on each call; an EnumDecoder or EnumTable built once
+ * is the better fit for large maps
+ */
 template<typename T, typename... defines_maps>
 std::string print_enum_entry(const T v, const defines_maps&... maps)
 {
-    std::stringstream ss;
+    std::string entries;
     auto first = true;
 
     auto search_in_map = [&](const auto& defines) {
         for (const auto& [define, str]: defines)
             if (v == (T) define)
             {
-                ss << (first ? "" : " & ") << str;
+                entries.append(first ? "" : " & ").append(str);
                 first = false;
             }
     };
 
     (search_in_map(maps), ...);
 
-    if (first)
-        return "";
-    return ss.str();
+    return entries;
 }
 
 template<typename... defines_maps>
 std::string print_enum_entry(const char* v, const defines_maps&... maps)
 {
-    std::stringstream ss;
+    std::string entries;
     auto first = true;
 
     auto search_in_map = [&](const auto& defines) {
         for (const auto& [define, str]: defines)
             if (strcmp(v, (const char*) define) == 0)
             {
-                ss << (first ? "" : " & ") << str;
+                entries.append(first ? "" : " & ").append(str);
                 first = false;
             }
     };
 
     (search_in_map(maps), ...);
 
-    if (first)
-        return "";
-    return ss.str();
+    return entries;
 }
 
 template<typename T, typename... defines_maps>
 std::string print_or_enum_entries(const T v, const defines_maps&... maps)
 {
-    std::stringstream ss;
+    std::string entries;
     auto first = true;
 
     auto search_in_map = [&](const auto& defines) {
         for (const auto& [define, str]: defines)
             if (v == (T) define || ((T) define > 0 && v >= (T) define && (v & (T) define) == (T) define))
             {
-                ss << (first ? "" : " | ") << str;
+                entries.append(first ? "" : " | ").append(str);
                 first = false;
             }
     };
 
     (search_in_map(maps), ...);
 
-    if (first)
-        return "";
-    return ss.str();
+    return entries;
 }
 
 inline void replace_all(std::string& str, const std::string& from, const std::string& to)
@@ -416,7 +592,7 @@ inline void replace_all(std::string& str, const std::string& from, const std::st
 
 inline std::string print_diff(const std::string& arg1, const std::string& arg2)
 {
-    std::stringstream ss;
+    std::string diff;
     const auto lines1 = get_lines(arg1);
     const auto lines2 = get_lines(arg2);
 
@@ -426,9 +602,9 @@ inline std::string print_diff(const std::string& arg1, const std::string& arg2)
     auto first = true;
 
     auto print_line = [&](const std::string& line, const std::string& prefix) {
-        if (!first) ss << std::endl;
+        if (!first) diff += '\n';
         first = false;
-        ss << prefix << line;
+        diff.append(prefix).append(line);
     };
 
     for (const auto& [idx1, idx2, identical]: lcs)
@@ -472,38 +648,111 @@ inline std::string print_diff(const std::string& arg1, const std::string& arg2)
         }
     }
 
-    if (ends_with(arg1, '\n') || ends_with(arg2, '\n')) ss << std::endl;
-    auto str = ss.str();
-    return ss.str();
+    if (ends_with(arg1, '\n') || ends_with(arg2, '\n')) diff += '\n';
+    return diff;
 }
 
 struct ArgsPrinter
 {
+    static void* operator new(const size_t size) { return allocate_object(size); }
+    static void operator delete(void* ptr) { deallocate_object(ptr); }
+
+    ArgsPrinter() = default;
+    ArgsPrinter(const ArgsPrinter&) = delete;
+    ArgsPrinter& operator=(const ArgsPrinter&) = delete;
+
+    explicit ArgsPrinter(const FunctionInfo& func) : binary_(mode == BINARY_MODE), stats_(mode == STATS_MODE),
+                                                     func_info_(&func)
+    {
+        if (binary_)
+            trace_buffer.begin_call(func.id);
+        start_call();
+    }
+
+    ~ArgsPrinter()
+    {
+        delete func_;
+        delete ret_;
+        for (const auto& arg: args_)
+            delete std::get<0>(arg);
+    }
+
     void push_arg(VirtArgPrinter* arg)
     {
-        std::stringstream ss;
+        if (stats_)
+        {
+            bytes_ += arg->buffer_bytes();
+            args_.emplace_back(arg, "", arg->get_os(), std::nullopt);
+            start_call();
+            return;
+        }
+        if (binary_)
+        {
+            arg->capture(false);
+            args_.emplace_back(arg, "", arg->get_os(), std::nullopt);
+            start_call();
+            return;
+        }
+        ScratchStream ss;
         std::ostream* os = arg->get_os();
-        arg->set_os(&ss);
+        arg->set_os(ss.get());
+        std::optional<std::string> snapshot;
+        if (!nested_ && !arg->snapshot(snapshot.emplace()))
+            snapshot.reset();
+        VisitScope scope;
         arg->print_arg();
-        args_.emplace_back(arg, ss.str(), os);
+        args_.emplace_back(arg, ss->str(), os, std::move(snapshot));
+        start_call();
     }
 
     void push_func(VirtArgPrinter* arg)
     {
         func_ = arg;
-        func_->set_print_endl(false);
-        func_->print_arg();
-        prefix += '\t';
+        if (!binary_ && !stats_)
+        {
+            func_->set_print_endl(false);
+            func_->print_arg();
+            prefix += '\t';
+        }
+        start_call();
     }
 
     void push_return(VirtArgPrinter* ret)
     {
-        ret_val_ = ret->get_value();
+        end_call();
         ret_ = ret;
+        if (stats_)
+        {
+            errno_ = errno;
+            error_ = ret->is_error();
+            return;
+        }
+        if (binary_)
+            return;
+        VisitScope scope;
+        ret_val_ = ret->get_value();
     }
 
     void print_args()
     {
+        end_call();
+        if (timing && func_info_ != nullptr)
+            record_latency(func_info_->id, call_end_ - call_start_);
+        if (stats_)
+        {
+            if (func_info_ != nullptr)
+                record_call(func_info_->id, error_, errno_, bytes_);
+            return;
+        }
+        if (binary_)
+        {
+            for (const auto& arg: args_)
+                std::get<0>(arg)->capture_after();
+            if (ret_ != nullptr)
+                ret_->capture(true);
+            trace_buffer.end_call();
+            return;
+        }
         if (func_ != nullptr)
         {
             if (!ret_val_.empty())
@@ -511,20 +760,69 @@ struct ArgsPrinter
             *func_->get_os() << std::endl;
         }
         std::ranges::for_each(args_, [&](const auto& arg) {
-            std::stringstream ss2;
-            std::get<0>(arg)->set_os(&ss2);
+            // Nothing ran since the arguments of a custom printer were printed, and a second rendering would not see
+            // the objects as they were visited the first time
+            if (nested_)
+            {
+                *std::get<2>(arg) << std::get<1>(arg);
+                return;
+            }
+            // Arguments whose bytes did not change print the same text as before the call
+            if (const auto& snapshot = std::get<3>(arg); snapshot.has_value())
+                if (std::string after; std::get<0>(arg)->snapshot(after) && after == *snapshot)
+                {
+                    *std::get<2>(arg) << std::get<1>(arg);
+                    return;
+                }
+
+            ScratchStream ss2;
+            std::get<0>(arg)->set_os(ss2.get());
+            VisitScope scope;
             std::get<0>(arg)->print_arg();
 
-            *std::get<2>(arg) << print_diff(std::get<1>(arg), ss2.str());
+            *std::get<2>(arg) << print_diff(std::get<1>(arg), ss2->str());
         });
         if (ret_ != nullptr)
+        {
+            VisitScope scope;
             ret_->print_arg();
+        }
+    }
+
+    /*
+     * The real call is timed from its start, stamped by the timing trampoline of its REAL_FUNCTION slot, to the first
+     * push_return() or print after it. Slots without a trampoline are timed from the last push before the end instead.
+     */
+    void start_call()
+    {
+        if (timing && call_end_ == 0)
+            call_start_ = timestamp();
     }
 
+    void end_call()
+    {
+        if (timing && call_end_ == 0)
+        {
+            call_end_ = timestamp();
+            if (real_call.start != 0 && !nested_)
+                call_start_ = real_call.start;
+        }
+    }
+
+    bool binary_ = false;
+    bool stats_ = false;
+    bool nested_ = visit_depth > 0; // Created by a custom printer while an argument is being printed
+    bool error_ = false;
+    int errno_ = 0;
+    uint64_t bytes_ = 0;
+    const FunctionInfo* func_info_ = nullptr;
+    uint64_t call_start_ = 0;
+    uint64_t call_end_ = 0;
     std::string ret_val_;
     VirtArgPrinter* func_ = nullptr;
     VirtArgPrinter* ret_ = nullptr;
-    std::vector<std::tuple<VirtArgPrinter*, std::string, std::ostream*>> args_{};
+    using ArgEntry = std::tuple<VirtArgPrinter*, std::string, std::ostream*, std::optional<std::string>>;
+    std::vector<ArgEntry, ArenaAllocator<ArgEntry>> args_{};
 };
 
 inline void print_args(ArgsVector args)
@@ -532,27 +830,30 @@ inline void print_args(ArgsVector args)
     std::ranges::for_each(args, [&](const auto& arg) { arg->print_arg(); });
 }
 
-struct ReferenceType
+/**
+ * Length of a printed array, read from a variable of any integral type whenever it is needed
+ *
+ * The type is erased through a function pointer rather than a virtual class, so printers hold it inline.
+ *
+ * @struct Reference libabii.h
+ */
+struct Reference
 {
-    virtual ~ReferenceType() = default;
-    virtual size_t get_ref() = 0;
-};
+    template<typename T>
+    explicit Reference(T& ref) : ref_(&ref),
+                                 get_([](const void* ptr) { return static_cast<size_t>(*static_cast<const T*>(ptr)); }) {}
 
-template<typename T>
-struct Reference final : ReferenceType
-{
-    explicit Reference(T& ref) : ref_(ref) {}
-
-    size_t get_ref() override
-    {
-        return ref_;
-    }
+    [[nodiscard]] size_t get_ref() const { return get_(ref_); }
 
 private:
-    T& ref_;
+    const void* ref_;
+    size_t (*get_)(const void*);
 };
 }
 
+#include "Snapshot.tpp"
+#include "TraceCapture.tpp"
 #include "ArgPrinter.tpp"
+#include "StaticArgsPrinter.tpp"
 
 #endif //LIBABII_H
@@ -0,0 +1,117 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+/*
+ * Built-in interceptors that keep abii::address_map() and abii::symbol_cache() current
+ *
+ * They are weak so that a plugin overriding one of these functions still links; such a plugin has to call the
+ * matching AddressMap or SymbolCache method itself. Ranges are forgotten before the real call and added after it, so a
+ * concurrent lookup can never trust memory that is being unmapped.
+ *
+ * dlopen() is deliberately not interposed: the real one would see us as its caller and resolve $ORIGIN and RUNPATH
+ * against libabii. Loads are noticed through link_map_generation() instead.
+ */
+
+#include <cstdarg>
+#include <dlfcn.h>
+#include <sys/mman.h>
+
+#include "AddressMap.h"
+#include "SymbolCache.h"
+
+namespace
+{
+template <typename T>
+T real_symbol(const char* name)
+{
+    return reinterpret_cast<T>(dlsym(RTLD_NEXT, name));
+}
+
+uintptr_t to_addr(const void* ptr)
+{
+    return reinterpret_cast<uintptr_t>(ptr);
+}
+}
+
+extern "C" {
+__attribute__((weak))
+void* mmap(void* addr, const size_t length, const int prot, const int flags, const int fd, const off_t offset)
+{
+    static const auto real_mmap = real_symbol<decltype(&mmap)>("mmap");
+    if (flags & MAP_FIXED)
+        abii::address_map().remove(to_addr(addr), length);
+    const auto ret = real_mmap(addr, length, prot, flags, fd, offset);
+    // Pages of a file mapping past the end of the file raise SIGBUS, so only anonymous ones are trusted
+    if (ret != MAP_FAILED && flags & MAP_ANONYMOUS)
+        abii::address_map().add(to_addr(ret), length, prot & PROT_READ);
+    return ret;
+}
+
+__attribute__((weak))
+void* mmap64(void* addr, const size_t length, const int prot, const int flags, const int fd, const off64_t offset)
+{
+    static const auto real_mmap64 = real_symbol<decltype(&mmap64)>("mmap64");
+    if (flags & MAP_FIXED)
+        abii::address_map().remove(to_addr(addr), length);
+    const auto ret = real_mmap64(addr, length, prot, flags, fd, offset);
+    // Pages of a file mapping past the end of the file raise SIGBUS, so only anonymous ones are trusted
+    if (ret != MAP_FAILED && flags & MAP_ANONYMOUS)
+        abii::address_map().add(to_addr(ret), length, prot & PROT_READ);
+    return ret;
+}
+
+__attribute__((weak))
+int munmap(void* addr, const size_t length)
+{
+    static const auto real_munmap = real_symbol<decltype(&munmap)>("munmap");
+    abii::address_map().remove(to_addr(addr), length);
+    return real_munmap(addr, length);
+}
+
+__attribute__((weak))
+void* mremap(void* old_address, const size_t old_size, const size_t new_size, const int flags, ...)
+{
+    static const auto real_mremap = real_symbol<decltype(&mremap)>("mremap");
+    void* new_address = nullptr;
+    if (flags & MREMAP_FIXED)
+    {
+        va_list args;
+        va_start(args, flags);
+        new_address = va_arg(args, void*);
+        va_end(args);
+        abii::address_map().remove(to_addr(new_address), new_size);
+    }
+    // The new range keeps the backing of the old one, so only a trusted anonymous mapping stays trusted
+    const auto anonymous = abii::address_map().remove(to_addr(old_address), old_size);
+    const auto ret = real_mremap(old_address, old_size, new_size, flags, new_address);
+    if (ret != MAP_FAILED && anonymous)
+        abii::address_map().add(to_addr(ret), new_size, true);
+    return ret;
+}
+
+__attribute__((weak))
+int mprotect(void* addr, const size_t len, const int prot)
+{
+    static const auto real_mprotect = real_symbol<decltype(&mprotect)>("mprotect");
+    if (!(prot & PROT_READ))
+        abii::address_map().protect(to_addr(addr), len, false);
+    const auto ret = real_mprotect(addr, len, prot);
+    if (ret == 0 && prot & PROT_READ)
+        abii::address_map().protect(to_addr(addr), len, true);
+    return ret;
+}
+
+__attribute__((weak))
+int dlclose(void* handle)
+{
+    static const auto real_dlclose = real_symbol<decltype(&dlclose)>("dlclose");
+    abii::address_map().begin_unload();
+    abii::symbol_cache().invalidate();
+    const auto ret = real_dlclose(handle);
+    abii::link_map_unloaded();
+    abii::symbol_cache().invalidate();
+    abii::address_map().end_unload();
+    return ret;
+}
+}
@@ -0,0 +1,56 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+/*
+ * Built-in pthread_create() interceptor that turns overrides on in threads started while ABII is loaded
+ *
+ * Doing it here keeps abii::redirect constant-initialized, so reading it on the interception path never goes through a
+ * TLS initialization wrapper. Like the other built-in interceptors it is weak; a plugin overriding pthread_create()
+ * has to set abii::redirect in the new thread itself.
+ */
+
+#include <dlfcn.h>
+#include <pthread.h>
+
+#include "libabii.h"
+
+namespace
+{
+using pthread_create_t = int (*)(pthread_t*, const pthread_attr_t*, void* (*)(void*), void*);
+
+struct ThreadStart
+{
+    void* (*routine)(void*);
+    void* arg;
+};
+
+void* start_thread(void* data)
+{
+    const auto start = *static_cast<ThreadStart*>(data);
+    delete static_cast<ThreadStart*>(data);
+    abii::redirect = abii::loaded.load(std::memory_order_acquire);
+    return start.routine(start.arg);
+}
+}
+
+extern "C" {
+__attribute__((weak))
+int pthread_create(pthread_t* thread, const pthread_attr_t* attr, void* (*routine)(void*), void* arg)
+{
+    static const auto real_pthread_create = reinterpret_cast<pthread_create_t>(dlsym(RTLD_NEXT, "pthread_create"));
+    // The allocations are ABII's own and must not be logged
+    const auto redirect = abii::redirect;
+    abii::redirect = false;
+    const auto start = new ThreadStart{routine, arg};
+    abii::redirect = redirect;
+    const auto ret = real_pthread_create(thread, attr, start_thread, start);
+    if (ret != 0)
+    {
+        abii::redirect = false;
+        delete start;
+        abii::redirect = redirect;
+    }
+    return ret;
+}
+}
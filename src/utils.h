@@ -5,8 +5,14 @@
 #ifndef ABII_UTILS_H
 #define ABII_UTILS_H
 
+#include <algorithm>
 #include <cassert>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
 #include <unicode/unistr.h>
 #include <unicode/ustream.h>
 
@@ -44,53 +50,167 @@ inline std::string strip(std::string str, const char& chr, const strip_side side
 
 inline std::vector<std::string> get_lines(const std::string& str)
 {
-    std::stringstream ss(str), ret_ss;
+    // Same lines as std::getline() would read
     std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(ss, line))
-        lines.push_back(line);
+    for (size_t start = 0; start < str.size();)
+    {
+        auto end = str.find('\n', start);
+        if (end == std::string::npos)
+            end = str.size();
+        lines.emplace_back(str, start, end - start);
+        start = end + 1;
+    }
     return lines;
 }
 
-inline std::vector<std::tuple<int, int, bool>> findLCS(const std::vector<std::string>& lines1,
-                                                       const std::vector<std::string>& lines2)
+/**
+ * line_key() - Returns the part of a printed line that identifies the argument, i.e. everything before the first ':'
+ */
+inline std::string_view line_key(const std::string& line)
 {
-    const auto m = lines1.size();
-    const auto n = lines2.size();
-    std::vector lcsLength(m + 1, std::vector(n + 1, 0));
+    return std::string_view(line).substr(0, line.find(':'));
+}
 
-    for (auto i = 1; i <= m; ++i)
+/*
+ * bisect_lcs() - Appends the matches between a[0, n) and b[0, m) to @p lcs
+ *
+ * Linear-space variant of Myers' O(ND) algorithm: the common prefix and suffix are matched directly, then the middle
+ * snake of the remaining edit graph splits the problem in two. @p v1 and @p v2 are scratch arrays shared by every
+ * level of the recursion.
+ */
+inline void bisect_lcs(const int* a, const int n, const int* b, const int m, const int a_off, const int b_off,
+                       std::vector<int>& v1, std::vector<int>& v2, std::vector<std::pair<int, int>>& lcs)
+{
+    auto prefix = 0;
+    while (prefix < n && prefix < m && a[prefix] == b[prefix])
     {
-        for (auto j = 1; j <= n; ++j)
+        lcs.emplace_back(a_off + prefix, b_off + prefix);
+        ++prefix;
+    }
+    a += prefix;
+    b += prefix;
+    const auto a_start = a_off + prefix, b_start = b_off + prefix;
+    auto len_a = n - prefix, len_b = m - prefix;
+    auto suffix = 0;
+    while (suffix < len_a && suffix < len_b && a[len_a - suffix - 1] == b[len_b - suffix - 1])
+        ++suffix;
+    len_a -= suffix;
+    len_b -= suffix;
+
+    if (len_a > 0 && len_b > 0)
+    {
+        const auto max_d = (len_a + len_b + 1) / 2;
+        const auto v_offset = max_d;
+        const auto v_length = 2 * max_d + 2;
+        std::fill_n(v1.begin(), v_length, -1);
+        std::fill_n(v2.begin(), v_length, -1);
+        v1[v_offset + 1] = 0;
+        v2[v_offset + 1] = 0;
+        const auto delta = len_a - len_b;
+        // If the total number of lines is odd, the forward path collides with the reverse path
+        const auto front = delta % 2 != 0;
+        auto k1_start = 0, k1_end = 0, k2_start = 0, k2_end = 0;
+        auto split_a = -1, split_b = -1;
+
+        for (auto d = 0; d < max_d && split_a == -1; ++d)
         {
-            auto arg1 = lines1[i - 1].substr(0, lines1[i - 1].find(':'));
-            auto arg2 = lines2[j - 1].substr(0, lines2[j - 1].find(':'));
-            if (arg1 == arg2)
-                lcsLength[i][j] = lcsLength[i - 1][j - 1] + 1;
-            else
-                lcsLength[i][j] = std::max(lcsLength[i - 1][j], lcsLength[i][j - 1]);
+            for (auto k1 = -d + k1_start; k1 <= d - k1_end && split_a == -1; k1 += 2)
+            {
+                const auto k1_offset = v_offset + k1;
+                auto x1 = k1 == -d || (k1 != d && v1[k1_offset - 1] < v1[k1_offset + 1])
+                              ? v1[k1_offset + 1]
+                              : v1[k1_offset - 1] + 1;
+                auto y1 = x1 - k1;
+                while (x1 < len_a && y1 < len_b && a[x1] == b[y1])
+                {
+                    ++x1;
+                    ++y1;
+                }
+                v1[k1_offset] = x1;
+                if (x1 > len_a)
+                    k1_end += 2;
+                else if (y1 > len_b)
+                    k1_start += 2;
+                else if (front)
+                    if (const auto k2_offset = v_offset + delta - k1;
+                        k2_offset >= 0 && k2_offset < v_length && v2[k2_offset] != -1 && x1 >= len_a - v2[k2_offset])
+                    {
+                        split_a = x1;
+                        split_b = y1;
+                    }
+            }
+
+            for (auto k2 = -d + k2_start; k2 <= d - k2_end && split_a == -1; k2 += 2)
+            {
+                const auto k2_offset = v_offset + k2;
+                auto x2 = k2 == -d || (k2 != d && v2[k2_offset - 1] < v2[k2_offset + 1])
+                              ? v2[k2_offset + 1]
+                              : v2[k2_offset - 1] + 1;
+                auto y2 = x2 - k2;
+                while (x2 < len_a && y2 < len_b && a[len_a - x2 - 1] == b[len_b - y2 - 1])
+                {
+                    ++x2;
+                    ++y2;
+                }
+                v2[k2_offset] = x2;
+                if (x2 > len_a)
+                    k2_end += 2;
+                else if (y2 > len_b)
+                    k2_start += 2;
+                else if (!front)
+                    if (const auto k1_offset = v_offset + delta - k2;
+                        k1_offset >= 0 && k1_offset < v_length && v1[k1_offset] != -1
+                        && v1[k1_offset] >= len_a - x2)
+                    {
+                        split_a = v1[k1_offset];
+                        split_b = v_offset + split_a - k1_offset;
+                    }
+            }
         }
-    }
 
-    std::vector<std::tuple<int, int, bool>> lcs;
-    auto i = m, j = n;
-    while (i > 0 && j > 0)
-    {
-        std::string arg1 = lines1[i - 1].substr(0, lines1[i - 1].find(':'));
-        std::string arg2 = lines2[j - 1].substr(0, lines2[j - 1].find(':'));
-        if (arg1 == arg2)
+        // Without a split the two ranges have nothing in common
+        if (split_a != -1)
         {
-            lcs.emplace_back(i - 1, j - 1, lines1[i - 1] == lines2[j - 1]);
-            --i;
-            --j;
+            bisect_lcs(a, split_a, b, split_b, a_start, b_start, v1, v2, lcs);
+            bisect_lcs(a + split_a, len_a - split_a, b + split_b, len_b - split_b, a_start + split_a,
+                       b_start + split_b, v1, v2, lcs);
         }
-        else if (lcsLength[i - 1][j] > lcsLength[i][j - 1])
-            --i;
-        else
-            --j;
     }
 
-    std::ranges::reverse(lcs);
+    for (auto i = 0; i < suffix; ++i)
+        lcs.emplace_back(a_start + len_a + i, b_start + len_b + i);
+}
+
+/**
+ * findLCS() - Finds the longest common subsequence of two printouts, comparing lines by their line_key()
+ *
+ * Keys are interned once, so the diff itself only compares integers and needs O(m + n) memory.
+ *
+ * @param lines1 Lines printed before the call
+ * @param lines2 Lines printed after the call
+ * @return (index in @p lines1, index in @p lines2, whether the full lines are identical) for every matched line
+ */
+inline std::vector<std::tuple<int, int, bool>> findLCS(const std::vector<std::string>& lines1,
+                                                       const std::vector<std::string>& lines2)
+{
+    const auto m = static_cast<int>(lines1.size());
+    const auto n = static_cast<int>(lines2.size());
+
+    std::unordered_map<std::string_view, int> ids;
+    std::vector<int> keys1(m), keys2(n);
+    for (auto i = 0; i < m; ++i)
+        keys1[i] = ids.try_emplace(line_key(lines1[i]), static_cast<int>(ids.size())).first->second;
+    for (auto j = 0; j < n; ++j)
+        keys2[j] = ids.try_emplace(line_key(lines2[j]), static_cast<int>(ids.size())).first->second;
+
+    std::vector<int> v1(m + n + 4), v2(m + n + 4);
+    std::vector<std::pair<int, int>> matches;
+    bisect_lcs(keys1.data(), m, keys2.data(), n, 0, 0, v1, v2, matches);
+
+    std::vector<std::tuple<int, int, bool>> lcs;
+    lcs.reserve(matches.size());
+    for (const auto& [i, j]: matches)
+        lcs.emplace_back(i, j, lines1[i] == lines2[j]);
     return lcs;
 }
 
@@ -106,10 +226,10 @@ inline std::string wide_to_narrow_char(const wchar_t wide_char)
 
 inline std::string wide_to_narrow_str(const std::wstring& wide_string)
 {
-    std::stringstream ss;
+    std::string narrow_string;
     for (const auto wchar : wide_string)
-        ss << wide_to_narrow_char(wchar);
-    return ss.str();
+        narrow_string += wide_to_narrow_char(wchar);
+    return narrow_string;
 }
 }
 
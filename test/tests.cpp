@@ -6,8 +6,16 @@
 
 #include <libabii.h>
 #include <boost/test/included/unit_test.hpp>
+#include <filesystem>
+#include <future>
+#include <iomanip>
+#include <random>
+#include <sys/mman.h>
+#include <thread>
 
 #include "custom_printers.h"
+#include "MappedLog.h"
+#include "TraceDecoder.h"
 
 #define TEST_TYPE(type, init_val)                               \
 {                                                               \
@@ -18,6 +26,40 @@
     delete pi_args;                                             \
 }
 
+/*
+ * Points $HOME at a temporary directory holding abii_log, so the tests that write logs never depend on abii_init()
+ * having created ~/abii_log. Log paths are resolved once per process, so every test shares the directory.
+ */
+struct TempLogDir
+{
+    TempLogDir()
+    {
+        char dir[] = "/tmp/abii_tests_XXXXXX";
+        if (mkdtemp(dir) == nullptr || mkdir((std::string(dir) + "/abii_log").c_str(), 0775) != 0)
+            throw std::runtime_error("Could not create a temporary log directory");
+        dir_ = dir;
+        if (const char* home = getenv("HOME"); home != nullptr)
+            old_home_ = home;
+        setenv("HOME", dir, 1);
+    }
+
+    ~TempLogDir()
+    {
+        if (old_home_.has_value())
+            setenv("HOME", old_home_->c_str(), 1);
+        else
+            unsetenv("HOME");
+        std::error_code ec;
+        std::filesystem::remove_all(dir_, ec);
+    }
+
+private:
+    std::string dir_;
+    std::optional<std::string> old_home_;
+};
+
+BOOST_TEST_GLOBAL_FIXTURE(TempLogDir);
+
 struct test_struct
 {
     bool a = BOOL_MAX;
@@ -52,6 +94,20 @@ std::ostream& operator<<(std::ostream& os, const test_struct& obj)
     OVERRIDE_STREAM_SUFFIX
 }
 
+struct shared_pair
+{
+    int* a;
+    int* b;
+};
+
+std::ostream& operator<<(std::ostream& os, const shared_pair& obj)
+{
+    OVERRIDE_STREAM_PREFIX
+    abii_args->push_arg(new abii::ArgPrinter(obj.a, "a", &os, PRINT_ENDL | RECURSE));
+    abii_args->push_arg(new abii::ArgPrinter(obj.b, "b", &os, PRINT_ENDL | RECURSE));
+    OVERRIDE_STREAM_SUFFIX
+}
+
 const char* va_func(const char* fmt, ...)
 {
     TRACE_LOGGER
@@ -187,3 +243,1185 @@ BOOST_AUTO_TEST_CASE(test_va_func)
 {
     va_func("Test va_func: %d, %s, %f\n", 42, "Hello, World!", 3.14);
 }
+
+BOOST_AUTO_TEST_CASE(test_binary_trace)
+{
+    auto abii_logger = Logger("test_binary_trace");
+    const auto path = abii::get_logfname(".abt");
+    unlink(path.c_str());
+
+    abii::mode = abii::BINARY_MODE;
+    auto& func = abii::register_function("test_binary_trace");
+    const auto pi_args = new abii::ArgsPrinter(func);
+    int arg = 42;
+    const char* str = "Hello, World!";
+    double ret = 3.14;
+    int out = 1;
+    int* out_ptr = &out;
+    pi_args->push_arg(new abii::ArgPrinter(arg, "arg", &std::cout));
+    pi_args->push_arg(new abii::ArgPrinter(str, "str", &std::cout));
+    pi_args->push_arg(new abii::ArgPrinter(out_ptr, "out", &std::cout));
+    // The callee writes through its pointer argument
+    out = 2;
+    pi_args->push_return(new abii::ArgPrinter(ret, "ret", &std::cout));
+    BOOST_CHECK_NO_THROW(pi_args->print_args());
+    delete pi_args;
+    abii::trace_buffer.flush();
+    abii::mode = abii::TEXT_MODE;
+
+    std::ifstream trace(path, std::ios::binary);
+    BOOST_REQUIRE(trace.is_open());
+    std::stringstream decoded;
+    BOOST_CHECK(abii::decode_trace(trace, decoded));
+    std::cout << decoded.str();
+    BOOST_CHECK(decoded.str().find("test_binary_trace(arg, str, out) = 3.14") != std::string::npos);
+    BOOST_CHECK(decoded.str().find("arg: (int) 42") != std::string::npos);
+    BOOST_CHECK(decoded.str().find("{Hello, World!}") != std::string::npos);
+    BOOST_CHECK(decoded.str().find(" {01 00 00 00} --> ") != std::string::npos);
+    BOOST_CHECK(decoded.str().find(" {02 00 00 00}") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_bomb_detector)
+{
+    auto abii_logger = Logger("test_bomb_detector");
+    const auto page = sysconf(_SC_PAGESIZE);
+    const auto mem = static_cast<char*>(mmap(nullptr, 2 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                                             0));
+    BOOST_REQUIRE(mem != MAP_FAILED);
+    mprotect(mem + page, page, PROT_NONE);
+
+    const auto str = mem + page - 6;
+    strcpy(str, "Hello");
+    BOOST_CHECK(abii::bomb_detector(str));
+    BOOST_CHECK_EQUAL(abii::readable_length(str), 5);
+    BOOST_CHECK_EQUAL(abii::readable_length(str, 3), 3);
+    BOOST_CHECK(abii::bomb_detector(reinterpret_cast<int*>(mem), page / sizeof(int)));
+    BOOST_CHECK(!abii::bomb_detector(reinterpret_cast<int*>(mem), page / sizeof(int) + 1));
+    BOOST_CHECK(!abii::bomb_detector(mem + page));
+    BOOST_CHECK(!abii::bomb_detector(static_cast<char*>(nullptr)));
+    TEST_TYPE(const char*, str)
+
+    // Unterminated strings running into an unreadable page
+    memset(mem, 'A', page);
+    BOOST_CHECK(!abii::bomb_detector(mem));
+    BOOST_CHECK_EQUAL(abii::readable_length(mem), -1);
+    BOOST_CHECK_EQUAL(abii::probe_terminated(mem, 1, 16), 16);
+    memset(mem + page - 2 * sizeof(wchar_t), 0, 2 * sizeof(wchar_t));
+    BOOST_CHECK_EQUAL(abii::readable_length(reinterpret_cast<wchar_t*>(mem)), page / sizeof(wchar_t) - 2);
+
+    munmap(mem, 2 * page);
+}
+
+BOOST_AUTO_TEST_CASE(test_address_map)
+{
+    auto abii_logger = Logger("test_address_map");
+    auto& map = abii::address_map();
+    const auto page = sysconf(_SC_PAGESIZE);
+    const auto mem = static_cast<char*>(mmap(nullptr, 3 * page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1,
+                                             0));
+    BOOST_REQUIRE(mem != MAP_FAILED);
+    const auto addr = reinterpret_cast<uintptr_t>(mem);
+
+    // Stack, heap and our own image are known without being registered
+    int local = 0;
+    BOOST_CHECK(map.readable_extent(reinterpret_cast<uintptr_t>(&local)) >= sizeof(local));
+    const auto heap = std::make_unique<int>(0);
+    BOOST_CHECK(map.readable_extent(reinterpret_cast<uintptr_t>(heap.get())) >= sizeof(int));
+    BOOST_CHECK(map.readable_extent(reinterpret_cast<uintptr_t>(&abii::mode)) >= sizeof(abii::mode));
+
+    // The built-in mmap interceptor may already have recorded the mapping
+    map.remove(addr, 3 * page);
+    BOOST_CHECK_EQUAL(map.readable_extent(addr), 0);
+    map.add(addr, 3 * page, true);
+    BOOST_CHECK_EQUAL(map.readable_extent(addr + 1), 3 * page - 1);
+    map.protect(addr + page, page, false);
+    BOOST_CHECK_EQUAL(map.readable_extent(addr), page);
+    BOOST_CHECK_EQUAL(map.readable_extent(addr + page), 0);
+    BOOST_CHECK_EQUAL(map.readable_extent(addr + 2 * page), page);
+    map.protect(addr + page, page, true);
+    BOOST_CHECK_EQUAL(map.readable_extent(addr), 3 * page);
+    BOOST_CHECK(map.remove(addr + 2 * page, page));
+    BOOST_CHECK_EQUAL(map.readable_extent(addr), 2 * page);
+    BOOST_CHECK(!map.remove(addr, 3 * page));
+    BOOST_CHECK_EQUAL(map.readable_extent(addr), 0);
+    munmap(mem, 3 * page);
+
+    // File mappings may fault past the end of the file, so they are left to the probe
+    const auto file = tmpfile();
+    BOOST_REQUIRE(file != nullptr);
+    const auto file_mem = mmap(nullptr, 2 * page, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    BOOST_REQUIRE(file_mem != MAP_FAILED);
+    BOOST_CHECK_EQUAL(map.readable_extent(reinterpret_cast<uintptr_t>(file_mem)), 0);
+    // Nor once moved, unlike anonymous mappings
+    const auto moved_file = mremap(file_mem, 2 * page, 4 * page, MREMAP_MAYMOVE);
+    BOOST_REQUIRE(moved_file != MAP_FAILED);
+    BOOST_CHECK_EQUAL(map.readable_extent(reinterpret_cast<uintptr_t>(moved_file)), 0);
+    munmap(moved_file, 4 * page);
+    const auto anon = mmap(nullptr, page, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    BOOST_REQUIRE(anon != MAP_FAILED);
+    const auto moved_anon = mremap(anon, page, 4 * page, MREMAP_MAYMOVE);
+    BOOST_REQUIRE(moved_anon != MAP_FAILED);
+    BOOST_CHECK_EQUAL(map.readable_extent(reinterpret_cast<uintptr_t>(moved_anon)), 4 * page);
+    munmap(moved_anon, 4 * page);
+    fclose(file);
+
+    // Loads are noticed without dl_iterate_phdr(), unloads through the dlclose() interceptor
+    const auto generation = abii::link_map_generation();
+    BOOST_CHECK_EQUAL(abii::link_map_generation(), generation);
+    const auto handle = dlopen("libanl.so.1", RTLD_NOW);
+    BOOST_REQUIRE(handle != nullptr);
+    const auto loaded = abii::link_map_generation();
+    BOOST_CHECK_NE(loaded, generation);
+    link_map* object = nullptr;
+    BOOST_REQUIRE_EQUAL(dlinfo(handle, RTLD_DI_LINKMAP, &object), 0);
+    BOOST_CHECK(map.readable_extent(reinterpret_cast<uintptr_t>(object->l_ld)) >= sizeof(ElfW(Dyn)));
+    dlclose(handle);
+    BOOST_CHECK_NE(abii::link_map_generation(), loaded);
+
+    std::istringstream maps("00400000-00452000 r-xp 00000000 08:02 173521      /usr/bin/dbus-daemon\n"
+                            "7ffd6a1b6000-7ffd6a1d7000 rw-p 00000000 00:00 0          [stack]\n"
+                            "7f29a1d9d000-7f29a1d9f000 rw-p 00000000 00:00 0\n");
+    const auto entries = abii::parse_maps(maps);
+    BOOST_REQUIRE_EQUAL(entries.size(), 3);
+    BOOST_CHECK_EQUAL(entries[0].start, 0x400000);
+    BOOST_CHECK_EQUAL(entries[0].end, 0x452000);
+    BOOST_CHECK_EQUAL(entries[0].perms, "r-xp");
+    BOOST_CHECK_EQUAL(entries[0].path, "/usr/bin/dbus-daemon");
+    BOOST_CHECK_EQUAL(entries[1].path, "[stack]");
+    BOOST_CHECK(entries[2].path.empty());
+}
+
+/*
+ * Quadratic dynamic-programming LCS that findLCS() replaced, kept as a reference
+ */
+static std::vector<std::tuple<int, int, bool>> reference_lcs(const std::vector<std::string>& lines1,
+                                                             const std::vector<std::string>& lines2)
+{
+    const auto m = lines1.size();
+    const auto n = lines2.size();
+    std::vector lcsLength(m + 1, std::vector(n + 1, 0));
+
+    for (size_t i = 1; i <= m; ++i)
+        for (size_t j = 1; j <= n; ++j)
+            if (abii::line_key(lines1[i - 1]) == abii::line_key(lines2[j - 1]))
+                lcsLength[i][j] = lcsLength[i - 1][j - 1] + 1;
+            else
+                lcsLength[i][j] = std::max(lcsLength[i - 1][j], lcsLength[i][j - 1]);
+
+    std::vector<std::tuple<int, int, bool>> lcs;
+    auto i = m, j = n;
+    while (i > 0 && j > 0)
+    {
+        if (abii::line_key(lines1[i - 1]) == abii::line_key(lines2[j - 1]))
+        {
+            lcs.emplace_back(i - 1, j - 1, lines1[i - 1] == lines2[j - 1]);
+            --i;
+            --j;
+        }
+        else if (lcsLength[i - 1][j] > lcsLength[i][j - 1])
+            --i;
+        else
+            --j;
+    }
+
+    std::ranges::reverse(lcs);
+    return lcs;
+}
+
+BOOST_AUTO_TEST_CASE(test_find_lcs)
+{
+    auto abii_logger = Logger("test_find_lcs");
+
+    // Printouts of the same argument before and after a call align the same way as with the reference
+    test_struct arg;
+    arg.k = &arg;
+    std::stringstream before, after;
+    abii::ArgPrinter(arg, "arg", &before).print_arg();
+    arg.c = 0;
+    arg.k = nullptr;
+    abii::ArgPrinter(arg, "arg", &after).print_arg();
+    const auto lines1 = abii::get_lines(before.str()), lines2 = abii::get_lines(after.str());
+    BOOST_CHECK(abii::findLCS(lines1, lines2) == reference_lcs(lines1, lines2));
+    BOOST_CHECK(abii::findLCS(lines1, {}).empty());
+    BOOST_CHECK(abii::findLCS({}, lines2).empty());
+
+    // On ambiguous input both implementations find an LCS of the same length, made of valid matches
+    std::mt19937 rng(1234);
+    for (auto iter = 0; iter < 500; ++iter)
+    {
+        std::vector<std::string> a(rng() % 40), b(rng() % 40);
+        for (auto& line: a)
+            line = std::string(1, static_cast<char>('a' + rng() % 4)) + ": " + std::to_string(rng() % 2);
+        for (auto& line: b)
+            line = std::string(1, static_cast<char>('a' + rng() % 4)) + ": " + std::to_string(rng() % 2);
+        const auto lcs = abii::findLCS(a, b);
+        BOOST_REQUIRE_EQUAL(lcs.size(), reference_lcs(a, b).size());
+        for (size_t k = 0; k < lcs.size(); ++k)
+        {
+            const auto [i, j, identical] = lcs[k];
+            BOOST_CHECK(abii::line_key(a[i]) == abii::line_key(b[j]));
+            BOOST_CHECK_EQUAL(identical, a[i] == b[j]);
+            if (k > 0)
+                BOOST_CHECK(std::get<0>(lcs[k - 1]) < i && std::get<1>(lcs[k - 1]) < j);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_snapshot)
+{
+    auto abii_logger = Logger("test_snapshot");
+    std::stringstream ss;
+    auto formatted = 0;
+    const std::function<std::string(int)> counting_printer = [&](const int) {
+        ++formatted;
+        return std::string("FLAG");
+    };
+
+    int unchanged = 1, changed = 2;
+    int buf[4] = {1, 2, 3, 4};
+    int* pbuf = buf;
+    const auto pi_args = new abii::ArgsPrinter();
+    const auto unchanged_printer = new abii::ArgPrinter(unchanged, "unchanged", &ss);
+    unchanged_printer->set_enum_printer_(counting_printer);
+    const auto changed_printer = new abii::ArgPrinter(changed, "changed", &ss);
+    changed_printer->set_enum_printer_(counting_printer);
+    const auto buf_printer = new abii::ArgPrinter(pbuf, "pbuf", &ss);
+    size_t len = 4;
+    buf_printer->set_len(len);
+    pi_args->push_arg(unchanged_printer);
+    pi_args->push_arg(changed_printer);
+    pi_args->push_arg(buf_printer);
+    BOOST_CHECK_EQUAL(formatted, 2);
+
+    changed = 3;
+    buf[2] = 5;
+    BOOST_CHECK_NO_THROW(pi_args->print_args());
+    delete pi_args;
+    std::cout << ss.str();
+
+    // Only the modified argument is formatted a second time
+    BOOST_CHECK_EQUAL(formatted, 3);
+    BOOST_CHECK(ss.str().find("unchanged: (int) 1 [FLAG]\n") != std::string::npos);
+    BOOST_CHECK(ss.str().find("changed: (int) 2 [FLAG] --> changed: (int) 3 [FLAG]") != std::string::npos);
+    BOOST_CHECK(ss.str().find("pbuf[2]: (int) 3 --> pbuf[2]: (int) 5") != std::string::npos);
+
+    // va_list printers read more than the argument's own bytes, whichever printer they are set on
+    std::string bytes;
+    abii::PrinterConfig config;
+    config.va_list_printers[1] = [](const char*, va_list, size_t) { return std::string(); };
+    const int const_buf[2] = {1, 2};
+    BOOST_CHECK(abii::ArgPrinter<const int[2]>(const_buf, "const_buf", 0, nullptr, &ss).snapshot(bytes));
+    BOOST_CHECK(!abii::ArgPrinter<const int[2]>(const_buf, "const_buf", 0, &config, &ss).snapshot(bytes));
+    const int* const const_pbuf = buf;
+    BOOST_CHECK(!abii::ArgPrinter<const int* const>(const_pbuf, "const_pbuf", 0, &config, &ss).snapshot(bytes));
+}
+
+BOOST_AUTO_TEST_CASE(test_printer_config)
+{
+    abii::PrinterConfigRef root;
+    BOOST_CHECK(root.get() == nullptr && root.enum_printer(0) == nullptr);
+    root.edit().enum_printers.insert({1, [](const void*) { return std::string("ELEM"); }});
+    BOOST_CHECK(root.enum_printer(0) == nullptr && root.enum_printer(1) != nullptr);
+
+    // Children borrow the configuration, and editing one leaves the parent's alone
+    abii::PrinterConfigRef child(root.get());
+    BOOST_CHECK(child.get() == root.get() && child.enum_printer(1) == root.enum_printer(1));
+    child.edit().enum_printers.insert({2, [](const void*) { return std::string(); }});
+    BOOST_CHECK(child.get() != root.get() && child.enum_printer(1) != nullptr);
+    BOOST_CHECK(root.enum_printer(2) == nullptr);
+
+    std::stringstream ss;
+    int buf[3] = {1, 2, 3};
+    int* pbuf = buf;
+    size_t len = 3;
+    abii::ArgPrinter printer(pbuf, "pbuf", &ss);
+    printer.set_len(len);
+    // Elements are printed at the depth of the pointer
+    printer.set_enum_printer_<int>([](const int i) { return std::to_string(i * 10); });
+    printer.print_arg();
+    BOOST_CHECK(ss.str().find("pbuf[0]: (int) 1 [10]\n") != std::string::npos);
+    BOOST_CHECK(ss.str().find("pbuf[2]: (int) 3 [30]") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_address_set)
+{
+    abii::AddressSet set;
+    std::vector<uintptr_t> addrs;
+    // Enough addresses to leave the inline slots, with runs of neighbours that collide
+    for (uintptr_t i = 1; i <= 1000; ++i)
+        addrs.push_back(i % 2 == 0 ? i * 4096 : i * 8);
+    for (const auto addr: addrs)
+    {
+        BOOST_CHECK(!set.contains(addr));
+        set.push(addr);
+    }
+    BOOST_CHECK_EQUAL(set.size(), addrs.size());
+    for (const auto addr: addrs)
+        BOOST_CHECK(set.contains(addr));
+
+    while (!addrs.empty())
+    {
+        set.pop();
+        BOOST_CHECK(!set.contains(addrs.back()));
+        addrs.pop_back();
+        if (!addrs.empty())
+            BOOST_CHECK(set.contains(addrs.back()) && set.contains(addrs.front()));
+    }
+    BOOST_CHECK(set.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_format_buffer)
+{
+    // The to_chars fast path prints the same text as the standard formatting
+    const auto check = [](const auto value) {
+        std::stringstream expected;
+        expected << value;
+        abii::ScratchStream ss;
+        *ss << abii::formatted(value);
+        BOOST_CHECK_EQUAL(ss->str(), expected.str());
+    };
+    check(0);
+    check(-42);
+    check(std::numeric_limits<long long>::min());
+    check(std::numeric_limits<unsigned long>::max());
+    check(3.25);
+    check(1e100);
+    check(-0.1f);
+    check(1.0L / 3);
+    check(static_cast<void*>(nullptr));
+    int x = 0;
+    check(&x);
+    check(static_cast<const void*>(&x));
+
+    // Streams reused by the pool start empty and with the default flags
+    {
+        abii::ScratchStream ss;
+        *ss << std::hex << std::showbase << std::setprecision(2) << abii::formatted(255) << abii::formatted(3.14159);
+        BOOST_CHECK_EQUAL(ss->str(), "0xff3.1");
+        abii::ScratchStream nested;
+        *nested << abii::formatted(255);
+        BOOST_CHECK_EQUAL(nested->str(), "255");
+    }
+    abii::ScratchStream ss;
+    *ss << abii::formatted(255) << ' ' << abii::formatted(3.14159);
+    BOOST_CHECK_EQUAL(ss->str(), "255 3.14159");
+
+    BOOST_CHECK_EQUAL(abii::element_name("arr", 12), "arr[12]");
+    BOOST_CHECK_EQUAL(abii::element_name("", size_t{0}), "[0]");
+
+    const std::vector<std::string> lines = {"a", "", "b"};
+    BOOST_CHECK(abii::get_lines("a\n\nb\n") == lines);
+    BOOST_CHECK(abii::get_lines("a\n\nb") == lines);
+    BOOST_CHECK(abii::get_lines("").empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_dedup)
+{
+    auto abii_logger = Logger("test_dedup");
+    int x = 7;
+    shared_pair pair{&x, &x};
+    auto ppair = &pair;
+
+    const auto print = [&] {
+        std::stringstream ss;
+        const auto pi_args = new abii::ArgsPrinter();
+        pi_args->push_arg(new abii::ArgPrinter(ppair, "ppair", &ss));
+        pi_args->print_args();
+        delete pi_args;
+        return ss.str();
+    };
+
+    const auto full = print();
+    const auto count = [](const std::string& str, const std::string& sub) {
+        size_t n = 0;
+        for (auto pos = str.find(sub); pos != std::string::npos; pos = str.find(sub, pos + 1))
+            ++n;
+        return n;
+    };
+    BOOST_CHECK_EQUAL(count(full, "(int) 7"), 2);
+    BOOST_CHECK(full.find("[SEE") == std::string::npos);
+
+    abii::dedup = true;
+    const auto deduped = print();
+    abii::dedup = false;
+    std::cout << deduped;
+    const auto x_addr = (std::stringstream() << &x).str();
+    BOOST_CHECK(deduped.find("ppair: (shared_pair*) ") != std::string::npos && deduped.find("[#1]\n") != std::string::npos);
+    BOOST_CHECK(deduped.find("a: (int*) " + x_addr + " [#2]\n") != std::string::npos);
+    BOOST_CHECK(deduped.find("b: (int*) " + x_addr + "\n") != std::string::npos);
+    BOOST_CHECK(deduped.find("\t[SEE #2]\n") != std::string::npos);
+    BOOST_CHECK_EQUAL(count(deduped, "(int) 7"), 1);
+    BOOST_CHECK(abii::used_addrs.empty());
+}
+
+BOOST_AUTO_TEST_CASE(test_async_writer)
+{
+    auto abii_logger = Logger("test_async_writer");
+    const auto path = std::string(getenv("HOME")) + "/abii_log/test_async_writer.txt";
+    unlink(path.c_str());
+    unlink((path + ".thread").c_str());
+    unlink((path + ".live").c_str());
+
+    setenv("ABII_WRITER", "async", 1);
+    abii::start_writer();
+    BOOST_REQUIRE(abii::writer_running());
+    abii::LogStream stream;
+    BOOST_REQUIRE(stream.open(path));
+    std::stringstream expected;
+    std::thread producer([&] {
+        abii::LogStream thread_stream;
+        thread_stream.open(path + ".thread");
+        for (auto i = 0; i < 1000; ++i)
+            thread_stream << "thread line " << i << std::endl;
+    });
+    for (auto i = 0; i < 10000; ++i)
+    {
+        stream << "line " << i << std::endl;
+        expected << "line " << i << std::endl;
+    }
+    producer.join();
+
+    // A thread still logging while the writer stops loses nothing, even if it never writes again
+    std::promise<void> checked;
+    std::atomic_int live_lines = 0;
+    std::thread live([&] {
+        abii::LogStream live_stream;
+        live_stream.open(path + ".live");
+        for (auto i = 0; i < 20000; ++i)
+        {
+            live_stream << "live line " << i << std::endl;
+            ++live_lines;
+        }
+        checked.get_future().wait();
+    });
+    while (live_lines < 100)
+        std::this_thread::yield();
+    abii::stop_writer();
+    unsetenv("ABII_WRITER");
+    BOOST_CHECK(!abii::writer_running());
+    while (live_lines < 20000)
+        std::this_thread::yield();
+    std::ifstream live_file(path + ".live");
+    std::string live_line;
+    auto live_count = 0;
+    while (std::getline(live_file, live_line))
+        BOOST_CHECK_EQUAL(live_line, "live line " + std::to_string(live_count++));
+    BOOST_CHECK_EQUAL(live_count, 20000);
+    checked.set_value();
+    live.join();
+
+    // Streams keep working synchronously once the writer has stopped
+    stream << "after stop" << std::endl;
+    expected << "after stop" << std::endl;
+    stream.close();
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    BOOST_CHECK(contents.str() == expected.str());
+    std::ifstream thread_file(path + ".thread");
+    std::string line;
+    auto lines = 0;
+    while (std::getline(thread_file, line))
+        BOOST_CHECK_EQUAL(line, "thread line " + std::to_string(lines++));
+    BOOST_CHECK_EQUAL(lines, 1000);
+}
+
+BOOST_AUTO_TEST_CASE(test_thread_redirect)
+{
+    auto abii_logger = Logger("test_thread_redirect");
+    // Threads intercept from their first call only if they start while ABII is loaded
+    const auto start_thread = [] {
+        bool started_redirect = false;
+        pthread_t thread;
+        pthread_create(&thread, nullptr, [](void* redirect) -> void* {
+            *static_cast<bool*>(redirect) = abii::redirect;
+            return nullptr;
+        }, &started_redirect);
+        pthread_join(thread, nullptr);
+        return started_redirect;
+    };
+    BOOST_CHECK(!start_thread());
+    abii::loaded = true;
+    BOOST_CHECK(start_thread());
+    abii::loaded = false;
+    BOOST_CHECK(!abii::redirect);
+}
+
+BOOST_AUTO_TEST_CASE(test_process_log)
+{
+    auto abii_logger = Logger("test_process_log");
+    abii::open_process_log("test_process_log\n");
+    std::vector<std::thread> threads;
+    for (auto t = 0; t < 4; ++t)
+        threads.emplace_back([] {
+            const auto tid = std::to_string(gettid());
+            for (auto i = 0; i < 200; ++i)
+            {
+                abii::abii_stream << "test_process_log " << tid << " record " << i << std::endl;
+                abii::abii_stream << "test_process_log " << tid << " end " << i << std::endl;
+                abii::abii_stream.end_record();
+            }
+        });
+    for (auto& thread: threads)
+        thread.join();
+
+    // Every record follows the tag of the thread that wrote it, in one piece
+    std::ifstream file(abii::get_process_logfname(".txt"));
+    BOOST_REQUIRE(file.is_open());
+    std::string tag, line, tid;
+    std::map<std::string, int> records;
+    while (std::getline(file, line))
+    {
+        if (line.starts_with("[thread "))
+        {
+            tag = line.substr(8, line.size() - 9);
+            continue;
+        }
+        if (!line.starts_with("test_process_log "))
+            continue;
+        std::istringstream ss(line);
+        std::string word;
+        int i;
+        ss >> word >> tid >> word >> i;
+        BOOST_CHECK_EQUAL(tid, tag);
+        if (word == "record")
+            BOOST_CHECK_EQUAL(i, records[tid]);
+        else
+            BOOST_CHECK_EQUAL(i, records[tid]++);
+    }
+    BOOST_CHECK_EQUAL(records.size(), 4);
+    for (const auto& [thread, count]: records)
+        BOOST_CHECK_EQUAL(count, 200);
+
+    // Records larger than a whole queue stay in one piece when the writer thread runs
+    setenv("ABII_WRITER", "async", 1);
+    setenv("ABII_QUEUE_SIZE", "4096", 1);
+    abii::start_writer();
+    BOOST_REQUIRE(abii::writer_running());
+    threads.clear();
+    for (auto t = 0; t < 4; ++t)
+        threads.emplace_back([] {
+            const auto tid = std::to_string(gettid());
+            for (auto i = 0; i < 50; ++i)
+            {
+                for (auto j = 0; j < 200; ++j)
+                    abii::abii_stream << "test_process_log " << tid << " large " << j << std::endl;
+                abii::abii_stream.end_record();
+            }
+        });
+    for (auto& thread: threads)
+        thread.join();
+    abii::stop_writer();
+    unsetenv("ABII_QUEUE_SIZE");
+    unsetenv("ABII_WRITER");
+
+    file.clear();
+    file.seekg(0);
+    std::map<std::string, int> lines;
+    records.clear();
+    while (std::getline(file, line))
+    {
+        if (line.starts_with("[thread "))
+        {
+            tag = line.substr(8, line.size() - 9);
+            continue;
+        }
+        std::istringstream ss(line);
+        std::string word;
+        int j;
+        ss >> word >> tid >> word >> j;
+        if (word != "large")
+            continue;
+        BOOST_CHECK_EQUAL(tid, tag);
+        BOOST_CHECK_EQUAL(j, lines[tid]);
+        lines[tid] = (j + 1) % 200;
+        if (lines[tid] == 0)
+            ++records[tid];
+    }
+    BOOST_CHECK_EQUAL(records.size(), 4);
+    for (const auto& [thread, count]: records)
+        BOOST_CHECK_EQUAL(count, 50);
+}
+
+long static_wrapper(int a, long b)
+{
+    OVERRIDE_STATIC_PREFIX(static_wrapper, "static_wrapper(a, b)", ABII_ARG(a), ABII_ARG(b))
+        abii_args->push_args();
+        const auto ret = a + b;
+    OVERRIDE_STATIC_SUFFIX(static_wrapper, ret)
+    return a + b;
+}
+
+BOOST_AUTO_TEST_CASE(test_static_args_printer)
+{
+    auto abii_logger = Logger("test_static_args_printer");
+    const auto& func = abii::register_function("test_static_args_printer");
+    int fd = 3;
+    int buf[4] = {1, 2, 3, 4};
+    int* pbuf = buf;
+    size_t len = 4;
+    int ret = 7;
+    abii::pre_fmtd_str str = "f(fd, pbuf)";
+
+    std::stringstream dynamic_ss;
+    abii::prefix = "";
+    const auto dynamic_args = new abii::ArgsPrinter(func);
+    dynamic_args->push_func(new abii::ArgPrinter(str, "", &dynamic_ss));
+    dynamic_args->push_arg(new abii::ArgPrinter(fd, "fd", &dynamic_ss));
+    const auto buf_printer = new abii::ArgPrinter(pbuf, "pbuf", &dynamic_ss);
+    buf_printer->set_len(len);
+    dynamic_args->push_arg(buf_printer);
+    buf[1] = 5;
+    dynamic_args->push_return(new abii::ArgPrinter(ret, "return", &dynamic_ss));
+    dynamic_args->print_args();
+    delete dynamic_args;
+
+    buf[1] = 2;
+    std::stringstream static_ss;
+    abii::prefix = "";
+    abii::StaticArgsPrinter static_args(func, str, [&] { return abii::ArgPrinter(fd, "fd", &static_ss); },
+                                        [&] { return abii::ArgPrinter(pbuf, "pbuf", &static_ss); });
+    static_args.set_os(&static_ss);
+    static_args.get<1>().set_len(len);
+    static_args.push_args();
+    buf[1] = 5;
+    static_args.print_args(ret);
+    std::cout << static_ss.str();
+
+    BOOST_CHECK_EQUAL(static_ss.str(), dynamic_ss.str());
+    BOOST_CHECK(static_ss.str().find("pbuf[1]: (int) 2 --> pbuf[1]: (int) 5") != std::string::npos);
+
+    // The macros log one record and restore interception
+    abii::redirect = true;
+    const auto sum = static_wrapper(2, 3);
+    const auto redirected = abii::redirect;
+    abii::redirect = false;
+    BOOST_CHECK_EQUAL(sum, 5);
+    BOOST_CHECK(redirected);
+    std::ifstream file(abii::get_process_logfname(".txt"));
+    BOOST_REQUIRE(file.is_open());
+    const std::string log((std::istreambuf_iterator(file)), std::istreambuf_iterator<char>());
+    BOOST_CHECK(log.find("static_wrapper(a, b) = 5\n\ta: (int) 2\n\tb: (long int) 3\n\treturn: (long int) 5\n") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_compression)
+{
+    auto abii_logger = Logger("test_compression");
+    std::string first, second;
+    for (auto i = 0; i < 1000; ++i)
+    {
+        first += "read(fd, buf, nbytes) = " + std::to_string(i) + "\n";
+        second += "write(fd, buf, n) = " + std::to_string(i) + "\n";
+    }
+    const auto log = abii::compress_block(first.data(), first.size()) +
+                     abii::compress_block(second.data(), second.size());
+    BOOST_CHECK(log.size() < (first.size() + second.size()) / 4);
+
+    // Concatenated blocks read back as one text
+    std::istringstream is(log);
+    std::ostringstream os;
+    BOOST_CHECK(abii::decompress_log(is, os));
+    BOOST_CHECK(os.str() == first + second);
+
+    // A block cut short by a crash loses only itself
+    const auto third = abii::compress_block(first.data(), first.size());
+    std::istringstream truncated(log + third.substr(0, third.size() / 2));
+    std::ostringstream partial;
+    BOOST_CHECK(!abii::decompress_log(truncated, partial));
+    BOOST_CHECK(partial.str().starts_with(first + second));
+
+    // Uncompressed logs pass through
+    std::istringstream plain(first);
+    std::ostringstream copy;
+    BOOST_CHECK(abii::decompress_log(plain, copy));
+    BOOST_CHECK(copy.str() == first);
+}
+
+BOOST_AUTO_TEST_CASE(test_mapped_log)
+{
+    auto abii_logger = Logger("test_mapped_log");
+    const auto path = std::string(getenv("HOME")) + "/abii_log/test_mapped_log.txt";
+    unlink(path.c_str());
+    const auto fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0664);
+    BOOST_REQUIRE(fd != -1);
+
+    // Small chunks, so records keep crossing chunk boundaries
+    size_t total = 0;
+    {
+        abii::MappedLog log(fd, 4096);
+        std::vector<std::thread> threads;
+        std::atomic<size_t> written = 0;
+        for (auto t = 0; t < 4; ++t)
+            threads.emplace_back([&log, &written, t] {
+                for (auto i = 0; i < 1000; ++i)
+                {
+                    const auto record = "thread " + std::to_string(t) + " record " + std::to_string(i) +
+                                        std::string(i % 37, '.') + "\n";
+                    log.append(record.data(), record.size());
+                    written += record.size();
+                }
+            });
+        for (auto& thread: threads)
+            thread.join();
+        total = written;
+
+        // Without trim() the file still ends with the zeros of its last chunk, like after a crash
+        struct stat st{};
+        fstat(fd, &st);
+        BOOST_CHECK(static_cast<size_t>(st.st_size) > total && st.st_size % 4096 == 0);
+        std::ifstream file(path, std::ios::binary);
+        std::ostringstream text;
+        BOOST_CHECK(abii::decompress_log(file, text));
+        BOOST_CHECK_EQUAL(text.str().size(), total);
+
+        log.trim();
+        const std::string after = "after trim\n";
+        log.append(after.data(), after.size());
+        total += after.size();
+    }
+    struct stat st{};
+    fstat(fd, &st);
+    BOOST_CHECK_EQUAL(static_cast<size_t>(st.st_size), total);
+    close(fd);
+
+    std::ifstream file(path);
+    std::string line;
+    int next[4] = {};
+    while (std::getline(file, line) && line.starts_with("thread "))
+    {
+        const auto t = line[7] - '0';
+        BOOST_CHECK(line.starts_with("thread " + std::to_string(t) + " record " + std::to_string(next[t]++)));
+    }
+    BOOST_CHECK_EQUAL(line, "after trim");
+    for (const auto count: next)
+        BOOST_CHECK_EQUAL(count, 1000);
+
+    // A write-only file cannot be mapped, so every append falls back to pwrite()
+    const auto write_only = open(path.c_str(), O_WRONLY | O_TRUNC | O_CLOEXEC);
+    BOOST_REQUIRE(write_only != -1);
+    {
+        abii::MappedLog log(write_only, 4096);
+        const std::string record(3000, 'x');
+        for (auto i = 0; i < 3; ++i)
+            log.append(record.data(), record.size());
+    }
+    BOOST_CHECK_EQUAL(lseek(write_only, 0, SEEK_END), 9000);
+    close(write_only);
+}
+
+BOOST_AUTO_TEST_CASE(test_arena)
+{
+    auto abii_logger = Logger("test_arena");
+    auto& arena = abii::arena();
+    const auto marker = arena.mark();
+    const auto first = arena.allocate(24);
+    BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(first) % alignof(std::max_align_t), 0);
+    const auto large = arena.allocate(256 * 1024, 64);
+    BOOST_CHECK_EQUAL(reinterpret_cast<uintptr_t>(large) % 64, 0);
+    arena.release(marker);
+    BOOST_CHECK_EQUAL(arena.allocate(24), first);
+    arena.release(marker);
+
+    // Printing the same call again reuses the memory of the previous one
+    int buf[4] = {1, 2, 3, 4};
+    int* pbuf = buf;
+    size_t len = 4;
+    const char* str = "arena";
+    size_t capacity = 0;
+    for (auto i = 0; i < 100; ++i)
+    {
+        const auto call_marker = arena.begin_scope();
+        std::stringstream os;
+        const auto args = new abii::ArgsPrinter();
+        const auto buf_printer = new abii::ArgPrinter(pbuf, "pbuf", &os);
+        buf_printer->set_len(len);
+        args->push_arg(buf_printer);
+        args->push_arg(new abii::ArgPrinter(str, "str", &os));
+        const auto used = arena.mark();
+        BOOST_CHECK(used.block != call_marker.block || used.offset != call_marker.offset);
+        args->print_args();
+        delete args;
+        arena.end_scope(call_marker);
+        if (i == 0)
+            capacity = arena.capacity();
+        BOOST_CHECK_EQUAL(arena.capacity(), capacity);
+    }
+
+    // Printers built outside an override come from the heap, so they never pin arena memory
+    BOOST_CHECK(!arena.in_scope());
+    const auto outside = arena.mark();
+    for (auto i = 0; i < 1000; ++i)
+    {
+        std::stringstream os;
+        const auto args = new abii::ArgsPrinter();
+        args->push_arg(new abii::ArgPrinter(str, "str", &os));
+        args->print_args();
+        delete args;
+    }
+    const auto after = arena.mark();
+    BOOST_CHECK_EQUAL(after.block, outside.block);
+    BOOST_CHECK_EQUAL(after.offset, outside.offset);
+    BOOST_CHECK_EQUAL(arena.capacity(), capacity);
+}
+
+struct base_type
+{
+    virtual ~base_type() = default;
+};
+
+struct derived_type final : base_type {};
+
+BOOST_AUTO_TEST_CASE(test_type_name)
+{
+    auto abii_logger = Logger("test_type_name");
+    static_assert(abii::type_name<int>() == "int");
+    static_assert(abii::type_name<test_struct*>() == "test_struct*");
+    const int value = 0;
+    BOOST_CHECK_EQUAL(abii::get_type(value), "int");
+
+    // Polymorphic objects are named after their dynamic type
+    const derived_type derived;
+    const base_type& base = derived;
+    BOOST_CHECK_EQUAL(abii::get_type(base), "derived_type");
+    BOOST_CHECK_EQUAL(abii::get_type(base).data(), abii::get_type(derived).data());
+}
+
+BOOST_AUTO_TEST_CASE(test_symbol_cache)
+{
+    auto abii_logger = Logger("test_symbol_cache");
+    int local = 0;
+    const auto heap = std::make_unique<int>(0);
+    const std::vector<const void*> addrs = {
+        reinterpret_cast<const void*>(&fopen), reinterpret_cast<const char*>(&fopen) + 1,
+        reinterpret_cast<const void*>(&dlsym), reinterpret_cast<const void*>(&environ),
+        reinterpret_cast<const void*>(&abii::demangle_cached), &local, heap.get()
+    };
+
+    // Names match dladdr() before and after the cache is invalidated
+    for (auto pass = 0; pass < 3; ++pass)
+    {
+        for (const auto addr: addrs)
+        {
+            Dl_info info;
+            std::string expected;
+            if (dladdr(addr, &info) && info.dli_sname != nullptr && info.dli_saddr != nullptr)
+                expected = abii::demangle(info.dli_sname);
+            BOOST_CHECK_EQUAL(abii::get_symbol_name(addr), expected);
+        }
+        if (pass == 1)
+            abii::symbol_cache().invalidate();
+    }
+    BOOST_CHECK_EQUAL(abii::get_symbol_name(reinterpret_cast<const void*>(&fopen)).empty(), false);
+}
+
+BOOST_AUTO_TEST_CASE(test_enum_decoder)
+{
+    auto abii_logger = Logger("test_enum_decoder");
+    const abii::defines_map<> open_defines = {
+        {O_RDONLY, "O_RDONLY"}, {O_WRONLY, "O_WRONLY"}, {O_RDWR, "O_RDWR"}, {O_CREAT, "O_CREAT"},
+        {O_EXCL, "O_EXCL"}, {O_TRUNC, "O_TRUNC"}, {O_APPEND, "O_APPEND"}, {O_CLOEXEC, "O_CLOEXEC"}
+    };
+    const abii::defines_map<> errno_defines = {{ENOENT, "ENOENT"}, {EACCES, "EACCES"}, {EWOULDBLOCK, "EWOULDBLOCK"},
+                                               {EAGAIN, "EAGAIN"}};
+    const abii::EnumDecoder<int> open_decoder(open_defines);
+    const abii::EnumDecoder<int> errno_decoder(errno_defines);
+
+    // Both decoders agree with the linear scans
+    for (const auto flags: {0, O_WRONLY, O_RDWR | O_CREAT | O_EXCL, O_WRONLY | O_APPEND | O_CLOEXEC, -1, 0x40000000})
+    {
+        BOOST_CHECK_EQUAL(open_decoder.flags(flags), abii::print_or_enum_entries(flags, open_defines));
+        BOOST_CHECK_EQUAL(open_decoder(flags), abii::print_enum_entry(flags, open_defines));
+    }
+    for (const auto error: {0, ENOENT, EAGAIN, EACCES})
+        BOOST_CHECK_EQUAL(errno_decoder(error), abii::print_enum_entry(error, errno_defines));
+    BOOST_CHECK_EQUAL(errno_decoder(EAGAIN), "EWOULDBLOCK & EAGAIN");
+
+    static constexpr abii::EnumTable modes(std::to_array<abii::EnumEntry<unsigned>>({
+        {S_IRUSR, "S_IRUSR"}, {S_IWUSR, "S_IWUSR"}, {S_IXUSR, "S_IXUSR"}, {S_IRWXU, "S_IRWXU"}
+    }));
+    BOOST_CHECK_EQUAL(modes.flags(S_IRUSR | S_IWUSR | S_IXUSR), "S_IRUSR | S_IWUSR | S_IXUSR | S_IRWXU");
+    BOOST_CHECK_EQUAL(modes.flags(S_IRUSR | S_IWUSR), "S_IRUSR | S_IWUSR");
+
+    // Text that does not fit is cut off, but its full length is returned
+    char buf[8];
+    BOOST_CHECK_EQUAL(modes.decode_flags(S_IRUSR | S_IWUSR, buf, sizeof(buf)), 17);
+    BOOST_CHECK_EQUAL(std::string_view(buf, sizeof(buf)), "S_IRUSR ");
+}
+
+std::string print_printf_args(const char* fmt, ...)
+{
+    va_list vargs;
+    va_start(vargs, fmt);
+    auto str = abii::print_variadic_args_printf(fmt, vargs, 0);
+    va_end(vargs);
+    return str;
+}
+
+BOOST_AUTO_TEST_CASE(test_printf_format)
+{
+    auto abii_logger = Logger("test_printf_format");
+    const auto format = abii::compile_printf_format("100%% %-08.3f|%*.*d|%lld %hhn%zu %s %Lg %");
+    std::vector<abii::printf_arg> kinds;
+    for (const auto& conversion: format.conversions)
+        kinds.push_back(conversion.kind);
+    const std::vector expected = {
+        abii::PA_DOUBLE, abii::PA_INT, abii::PA_INT, abii::PA_INT, abii::PA_LONG_LONG, abii::PA_COUNT_POINTER,
+        abii::PA_UNSIGNED_LONG_LONG, abii::PA_STRING, abii::PA_LONG_DOUBLE
+    };
+    BOOST_CHECK_EQUAL_COLLECTIONS(kinds.begin(), kinds.end(), expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(format.conversions[0].conversion, 'f');
+    BOOST_CHECK_EQUAL(format.conversions[1].conversion, '*');
+    BOOST_CHECK_EQUAL(format.conversions[2].conversion, '*');
+    BOOST_CHECK_EQUAL(format.conversions[3].conversion, 'd');
+
+    // Positional arguments are pulled in argument order, and only up to the first one the format never names
+    const auto positional = abii::compile_printf_format("%3$s %1$*2$d %1$d");
+    BOOST_REQUIRE_EQUAL(positional.conversions.size(), 3);
+    BOOST_CHECK_EQUAL(positional.conversions[0].kind, abii::PA_INT);
+    BOOST_CHECK_EQUAL(positional.conversions[0].conversion, 'd');
+    BOOST_CHECK_EQUAL(positional.conversions[1].conversion, '*');
+    BOOST_CHECK_EQUAL(positional.conversions[2].kind, abii::PA_STRING);
+    BOOST_CHECK_EQUAL(abii::compile_printf_format("%1$d %3$s").conversions.size(), 1);
+    BOOST_CHECK(abii::compile_printf_format("%d %2$s").conversions.empty());
+
+    // The same text is compiled once, whatever its address
+    char copy[] = "%d %s";
+    BOOST_CHECK_EQUAL(&abii::printf_format("%d %s"), &abii::printf_format(copy));
+    copy[1] = 'f';
+    BOOST_CHECK_EQUAL(abii::printf_format(copy).conversions[0].kind, abii::PA_DOUBLE);
+
+    // '*' widths are arguments of their own, so the following arguments stay aligned
+    const auto printed = print_printf_args("%*d%%%s", 4, 42, "str");
+    BOOST_CHECK(printed.find("[0]: (int) 4\n") != std::string::npos);
+    BOOST_CHECK(printed.find("[1]: (int) 42\n") != std::string::npos);
+    BOOST_CHECK(printed.find("[2]: (const char*) ") != std::string::npos);
+
+    const auto reordered = print_printf_args("%2$s %1$lld", 7LL, "str");
+    BOOST_CHECK(reordered.find("[0]: (long long int) 7\n") != std::string::npos);
+    BOOST_CHECK(reordered.find("[1]: (const char*) ") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_sampling)
+{
+    auto abii_logger = Logger("test_sampling");
+    BOOST_CHECK(abii::configure_sampling(
+        "every=4,test_sampling_rate:every=1,test_sampling_rate:rate=1,test_sampling_rate:burst=3"));
+    BOOST_CHECK(abii::sampling);
+
+    auto& every = abii::register_function("test_sampling_every");
+    auto logged = 0;
+    for (auto i = 0; i < 8; ++i)
+        logged += abii::sample(every.sample);
+    BOOST_CHECK_EQUAL(logged, 2);
+    BOOST_CHECK_EQUAL(every.sample.dropped, 6);
+
+    auto& rate = abii::register_function("test_sampling_rate");
+    logged = 0;
+    for (auto i = 0; i < 10; ++i)
+        logged += abii::sample(rate.sample);
+    BOOST_CHECK_EQUAL(logged, 3);
+    BOOST_CHECK_EQUAL(rate.sample.dropped, 7);
+
+    // The budget is counted per thread
+    BOOST_CHECK(abii::configure_sampling("budget=2"));
+    auto& budget = abii::register_function("test_sampling_budget");
+    std::thread([&] {
+        logged = 0;
+        for (auto i = 0; i < 5; ++i)
+            logged += abii::sample(budget.sample);
+    }).join();
+    BOOST_CHECK_EQUAL(logged, 2);
+    BOOST_CHECK_EQUAL(budget.sample.dropped, 3);
+
+    BOOST_CHECK(!abii::configure_sampling("every=0,malloc:budget=1,rate"));
+    BOOST_CHECK(abii::configure_sampling(""));
+    BOOST_CHECK(!abii::sampling);
+}
+
+static volatile sig_atomic_t test_filter_signals = 0;
+
+BOOST_AUTO_TEST_CASE(test_filter)
+{
+    auto abii_logger = Logger("test_filter");
+    BOOST_CHECK(abii::configure_filter("test_filter_open*,test_filter_read,-test_filter_openat"));
+    BOOST_CHECK(abii::filter_allows("test_filter_open"));
+    BOOST_CHECK(abii::filter_allows("test_filter_open64"));
+    BOOST_CHECK(abii::filter_allows("test_filter_read"));
+    BOOST_CHECK(!abii::filter_allows("test_filter_openat"));
+    BOOST_CHECK(!abii::filter_allows("test_filter_readv"));
+    BOOST_CHECK(!abii::register_function("test_filter_write").enabled);
+
+    // Rules read from a file apply to registered functions on reload
+    const auto path = std::string(getenv("HOME")) + "/abii_log/test_filter.rules";
+    std::ofstream(path) << "# only writes\ntest_filter_write*\n";
+    BOOST_CHECK(abii::configure_filter(("@" + path).c_str()));
+    auto& write = abii::register_function("test_filter_write");
+    auto& read = abii::register_function("test_filter_read");
+    BOOST_CHECK(!write.enabled);
+    abii::reload_filter();
+    BOOST_CHECK(write.enabled);
+    BOOST_CHECK(!read.enabled);
+
+    std::ofstream(path) << "-test_filter_write\n";
+    abii::reload_filter();
+    BOOST_CHECK(!write.enabled);
+    BOOST_CHECK(read.enabled);
+
+    // The reload signal is opt-in and chains to the program's own handler, which comes back once the watcher stops
+    BOOST_CHECK_EQUAL(abii::parse_signal("USR1"), SIGUSR1);
+    BOOST_CHECK_EQUAL(abii::parse_signal("SIGUSR2"), SIGUSR2);
+    BOOST_CHECK_EQUAL(abii::parse_signal("12"), 12);
+    BOOST_CHECK_EQUAL(abii::parse_signal("SIGNOPE"), 0);
+    const auto handler = [](int) { test_filter_signals = test_filter_signals + 1; };
+    const auto previous = signal(SIGUSR1, handler);
+    abii::start_filter_watcher(SIGUSR1);
+    raise(SIGUSR1);
+    BOOST_CHECK_EQUAL(test_filter_signals, 1);
+    abii::stop_filter_watcher();
+    BOOST_CHECK(signal(SIGUSR1, previous) == handler);
+    unlink(path.c_str());
+
+    BOOST_CHECK(abii::configure_filter(""));
+    abii::reload_filter();
+    BOOST_CHECK(write.enabled);
+}
+
+REAL_FUNCTION(strlen, real_strlen)
+REAL_FUNCTION(snprintf, real_snprintf)
+
+// Slot declared the way plugins did before REAL_FUNCTION, resolved by the OVERRIDE macros
+static decltype(&labs) real_labs = nullptr;
+
+extern "C" long labs(const long x)
+{
+    OVERRIDE_PREFIX(real_labs)
+        const auto ret = real_labs(x);
+    OVERRIDE_SUFFIX(real_labs, ret)
+    return real_labs(x);
+}
+
+BOOST_AUTO_TEST_CASE(test_real_function)
+{
+    auto abii_logger = Logger("test_real_function");
+    // Calls before resolve_real_functions() go through the stubs
+    BOOST_CHECK_EQUAL(real_strlen("Hello"), 5);
+    BOOST_CHECK(real_strlen == dlsym(RTLD_NEXT, "strlen"));
+    char buf[32];
+    BOOST_CHECK_EQUAL(real_snprintf(buf, sizeof(buf), "%d %s %.1f", 42, "str", 1.5), 10);
+    BOOST_CHECK_EQUAL(std::string(buf), "42 str 1.5");
+
+    abii::resolve_real_functions();
+    BOOST_CHECK(real_strlen == dlsym(RTLD_NEXT, "strlen"));
+    BOOST_CHECK(real_snprintf == dlsym(RTLD_NEXT, "snprintf"));
+
+    const auto volatile legacy = &labs;
+    BOOST_CHECK_EQUAL(legacy(-3), 3);
+    BOOST_CHECK(real_labs == dlsym(RTLD_NEXT, "labs"));
+}
+
+REAL_FUNCTION(usleep, real_usleep)
+
+BOOST_AUTO_TEST_CASE(test_latency)
+{
+    auto abii_logger = Logger("test_latency");
+    using abii::LatencyHistogram;
+    for (const auto value: std::to_array<uint64_t>({0, 1, 31, 32, 33, 1000, 123456789, UINT64_MAX}))
+    {
+        const auto bucket = LatencyHistogram::bucket_of(value);
+        BOOST_CHECK_LT(bucket, LatencyHistogram::BUCKETS);
+        BOOST_CHECK_GE(LatencyHistogram::bucket_high(bucket), value);
+        // Buckets are at most 1/SUB_BUCKETS of their value wide
+        BOOST_CHECK_LE(LatencyHistogram::bucket_high(bucket) - value, value / LatencyHistogram::SUB_BUCKETS);
+        if (bucket != 0)
+            BOOST_CHECK_LT(LatencyHistogram::bucket_high(bucket - 1), value);
+    }
+
+    abii::timing = true;
+    abii::start_timing();
+    auto& func = abii::register_function("test_latency");
+    // Every thread keeps its own histogram, which the summary merges
+    const auto record = [&] {
+        for (uint64_t i = 1; i <= 1000; ++i)
+            abii::record_latency(func.id, i * 1000);
+    };
+    std::thread(record).join();
+    record();
+
+    const auto args = new abii::ArgsPrinter(func);
+    usleep(2000);
+    args->push_return(new abii::ArgPrinter(0, "ret", &std::cout));
+    args->print_args();
+    delete args;
+
+    // Calls through a REAL_FUNCTION slot are timed from the real call itself, even with arguments pushed after it
+    abii::resolve_real_functions();
+    abii::time_real_functions();
+    auto& real_func = abii::register_function("test_latency_real");
+    const auto real_args = new abii::ArgsPrinter(real_func);
+    abii::arm_real_call(&real_usleep);
+    real_usleep(2000);
+    std::stringstream ss;
+    real_args->push_arg(new abii::ArgPrinter(0, "after", &ss));
+    real_args->push_return(new abii::ArgPrinter(0, "ret", &ss));
+    real_args->print_args();
+    delete real_args;
+    abii::timing = false;
+    abii::resolve_real_functions();
+    BOOST_CHECK_EQUAL(abii::latency_summary(real_func.id).count, 1);
+    BOOST_CHECK_GE(abii::latency_summary(real_func.id).max, 2000000.0);
+
+    const auto summary = abii::latency_summary(func.id);
+    BOOST_CHECK_EQUAL(summary.count, 2001);
+    BOOST_CHECK_LT(summary.p50, summary.p99);
+    BOOST_CHECK_LE(summary.p999, summary.max);
+    BOOST_CHECK_GE(summary.max, 2000000.0);
+
+    std::stringstream table;
+    abii::print_latency_table(table);
+    BOOST_CHECK(table.str().find("test_latency") != std::string::npos);
+}
+
+BOOST_AUTO_TEST_CASE(test_stats)
+{
+    auto abii_logger = Logger("test_stats");
+    BOOST_CHECK(abii::error_value(-1));
+    BOOST_CHECK(!abii::error_value(0));
+    BOOST_CHECK(!abii::error_value(static_cast<size_t>(-1)));
+    BOOST_CHECK(abii::error_value(static_cast<void*>(nullptr)));
+    BOOST_CHECK(abii::error_value(MAP_FAILED));
+
+    abii::mode = abii::STATS_MODE;
+    auto& func = abii::register_function("test_stats");
+    const auto call = [&](const ssize_t ret, const int err) {
+        const auto args = new abii::ArgsPrinter(func);
+        char buf[16];
+        size_t len = sizeof(buf);
+        const auto buf_printer = new abii::ArgPrinter(static_cast<void*>(buf), "buf");
+        buf_printer->set_len(len);
+        args->push_arg(buf_printer);
+        errno = err;
+        args->push_return(new abii::ArgPrinter(ret, "ret"));
+        args->print_args();
+        delete args;
+    };
+    call(16, 0);
+    // Counters of exited threads are merged when they exit
+    std::thread([&] {
+        call(-1, ENOENT);
+        call(-1, EACCES);
+    }).join();
+    call(-1, ENOENT);
+    abii::mode = abii::TEXT_MODE;
+
+    const auto totals = abii::call_totals(func.id);
+    BOOST_CHECK_EQUAL(totals.calls, 4);
+    BOOST_CHECK_EQUAL(totals.errors, 3);
+    BOOST_CHECK_EQUAL(totals.bytes, 64);
+
+    std::stringstream summary;
+    abii::write_stats(summary);
+    BOOST_CHECK(summary.str().find("test_stats") != std::string::npos);
+    BOOST_CHECK(summary.str().find("ENOENT") != std::string::npos);
+    BOOST_CHECK(summary.str().find("EACCES") != std::string::npos);
+}
@@ -0,0 +1,58 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include <docopt.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "Compression.h"
+
+static constexpr auto HELP = R"(
+abii-cat - Print compressed ABII text logs
+
+Usage: abii-cat [--output <file>] <log>...
+
+Options:
+    -h --help                     Show this screen.
+    --version                     Show the version number.
+    --output <file>               Write the text to <file> instead of stdout.
+)";
+
+int main(const int argc, char** argv)
+{
+    std::map<std::string, docopt::value> args =
+        docopt::docopt(HELP, {argv + 1, argv + argc}, true, "ABII v0.0.1");
+
+    std::ofstream output;
+    if (args["--output"])
+    {
+        output.open(args["--output"].asString(), std::ios::binary);
+        if (!output.is_open())
+        {
+            std::cerr << "Could not open " << args["--output"].asString() << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& os = output.is_open() ? output : std::cout;
+
+    auto status = 0;
+    for (const auto& path : args["<log>"].asStringList())
+    {
+        std::ifstream log(path, std::ios::binary);
+        if (!log.is_open())
+        {
+            std::cerr << "Could not open " << path << std::endl;
+            status = 1;
+            continue;
+        }
+        // A log cut short by a crash still prints every complete block
+        if (!abii::decompress_log(log, os))
+        {
+            std::cerr << path << " is truncated or corrupted" << std::endl;
+            status = 1;
+        }
+    }
+    return status;
+}
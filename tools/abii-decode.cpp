@@ -0,0 +1,57 @@
+//
+// Created by Trent Tanchin on 10/17/26.
+//
+
+#include <docopt.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "TraceDecoder.h"
+
+static constexpr auto HELP = R"(
+abii-decode - Render binary ABII traces as text
+
+Usage: abii-decode [--output <file>] <trace>...
+
+Options:
+    -h --help                     Show this screen.
+    --version                     Show the version number.
+    --output <file>               Write the decoded trace to <file> instead of stdout.
+)";
+
+int main(const int argc, char** argv)
+{
+    std::map<std::string, docopt::value> args =
+        docopt::docopt(HELP, {argv + 1, argv + argc}, true, "ABII v0.0.1");
+
+    std::ofstream output;
+    if (args["--output"])
+    {
+        output.open(args["--output"].asString());
+        if (!output.is_open())
+        {
+            std::cerr << "Could not open " << args["--output"].asString() << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& os = output.is_open() ? output : std::cout;
+
+    auto status = 0;
+    for (const auto& path : args["<trace>"].asStringList())
+    {
+        std::ifstream trace(path, std::ios::binary);
+        if (!trace.is_open())
+        {
+            std::cerr << "Could not open " << path << std::endl;
+            status = 1;
+            continue;
+        }
+        if (!abii::decode_trace(trace, os))
+        {
+            std::cerr << "Failed to decode " << path << std::endl;
+            status = 1;
+        }
+    }
+    return status;
+}